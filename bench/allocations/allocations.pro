@@ -0,0 +1,10 @@
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = allocationsbench
+TEMPLATE = app
+
+include(../../src/src.pri)
+include(../common/common.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,264 @@
+// Counts the heap allocations made on the main thread by the work
+// MprisInterface repeats while a video plays:
+//
+//   - snapshot ticks: the poll that sends the snapshot query, and
+//     applySnapshot() with the result, which differs from the last one only
+//     in its position
+//   - callController<Seek>() and callController<SetVolume>()
+//
+// runJavaScript() itself allocates inside QtWebEngine, so ticks and calls
+// are compared with the same number of bare runJavaScript() calls of the
+// same script. The check passes if qtwebflix adds no allocation of its own
+// to them, and applySnapshot(), which does not reach QtWebEngine, makes
+// none at all.
+//
+// malloc() and friends are replaced along with operator new, as Qt's
+// containers and strings allocate through malloc(). Only glibc offers the
+// __libc_* entry points used to forward to the real allocator.
+//
+// Usage: allocationsbench [ticks]
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QWebEngineView>
+
+#include "fixtures.h"
+#include "mainwindow.h"
+#include "measure.h"
+#include "mprisinterface.h"
+#include "mprisplayerhost.h"
+#include "scriptcache.h"
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+}
+
+namespace {
+
+// Set around the code being measured, other threads are not counted.
+thread_local bool counting = false;
+std::atomic<long> allocations(0);
+
+void *counted(void *pointer) {
+  if (counting) {
+    ++allocations;
+  }
+  return pointer;
+}
+
+} // namespace
+
+extern "C" {
+
+void *malloc(size_t size) { return counted(__libc_malloc(size)); }
+
+void *calloc(size_t count, size_t size) {
+  return counted(__libc_calloc(count, size));
+}
+
+void *realloc(void *pointer, size_t size) {
+  return counted(__libc_realloc(pointer, size));
+}
+
+void *memalign(size_t alignment, size_t size) {
+  return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+  *pointer = counted(__libc_memalign(alignment, size));
+  return *pointer ? 0 : ENOMEM;
+}
+
+void free(void *pointer) { __libc_free(pointer); }
+
+} // extern "C"
+
+void *operator new(size_t size) {
+  void *pointer = counted(__libc_malloc(size ? size : 1));
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return counted(__libc_malloc(size ? size : 1));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return counted(__libc_malloc(size ? size : 1));
+}
+
+void operator delete(void *pointer) noexcept { __libc_free(pointer); }
+void operator delete[](void *pointer) noexcept { __libc_free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { __libc_free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept {
+  __libc_free(pointer);
+}
+
+// Reaches the protected parts of MprisInterface that a tick runs through.
+class BenchInterface : public MprisInterface {
+  Q_OBJECT
+
+public:
+  explicit BenchInterface(const Provider &provider)
+      : MprisInterface(provider) {
+    // The private slot polling the page on every scheduler tick.
+    connect(this, SIGNAL(tick()), this, SLOT(pollTimerFired()));
+  }
+
+  using MprisInterface::applySnapshot;
+  using MprisInterface::scriptWorld;
+  using MprisInterface::snapshotScript;
+
+  template <ControllerCall call> void callWith(double argument) {
+    callController<call>(argument);
+  }
+
+signals:
+  void tick();
+};
+
+namespace {
+
+// Give up on a script after this many milliseconds.
+const int timeout = 30000;
+// Runs of each measured call before counting, so that buffers, caches and
+// published values are in place.
+const int warmup = 10;
+
+// Allocations made by `count` runs of `measured`, with `between` run
+// uncounted after each one.
+long count(int runs, const std::function<void()> &measured,
+           const std::function<void()> &between) {
+  long total = 0;
+  for (int i = 0; i < warmup + runs; ++i) {
+    long before = allocations;
+    counting = true;
+    measured();
+    counting = false;
+    if (i >= warmup) {
+      total += allocations - before;
+    }
+    between();
+  }
+  return total;
+}
+
+// Passes if `allocated` does not exceed `allowed`, what the same number of
+// bare runJavaScript() calls took.
+bool check(const QString &what, long allocated, long allowed, int runs) {
+  bool passed = allocated <= allowed;
+  QTextStream(stdout) << (passed ? "PASS " : "FAIL ") << what << ": "
+                      << allocated << " allocations in " << runs
+                      << " runs, at most " << allowed << " allowed\n";
+  return passed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  QTemporaryDir home;
+  useHome(home.path());
+
+  ScriptCache::registerScheme();
+  QApplication app(argc, argv);
+  int ticks = app.arguments().value(1, "1000").toInt();
+  if (!home.isValid() || ticks <= 0 || !writeFixtureSettings()) {
+    QTextStream(stderr) << "Could not set up the settings in " << home.path()
+                        << "\n";
+    return 1;
+  }
+
+  MainWindow w;
+  w.show();
+  QWebEnginePage *page = w.webView()->page();
+
+  // A backend of its own, driving a player of its own, so that the one
+  // MainWindow attached is left alone.
+  Provider provider;
+  provider.name = "bench";
+  MprisPlayerHost host;
+  BenchInterface backend(provider);
+  backend.setup(&w, &host);
+  quint32 world = backend.scriptWorld();
+
+  // Results are delivered in order, so once this one is back so are the
+  // queries sent before it.
+  auto settle = [&]() { runScript(page, "0", world, timeout); };
+
+  bool passed = true;
+
+  QString snapshotScript = backend.snapshotScript();
+  passed &= check(
+      "snapshot query", count(ticks, [&]() { emit backend.tick(); }, settle),
+      count(ticks,
+            [&]() {
+              page->runJavaScript(snapshotScript, world,
+                                  [](const QVariant &) {});
+            },
+            settle),
+      ticks);
+
+  // A video playing on, as the controller reports it.
+  QVariantMap snapshot{{"state", "playing"},
+                       {"position", 0.0},
+                       {"duration", 1800.0},
+                       {"volume", 1.0},
+                       {"rate", 1.0},
+                       {"title", "Fixture Series"},
+                       {"nid", "80000002"},
+                       {"arturl", "http://video.localhost/art.png"}};
+  QElapsedTimer playing;
+  playing.start();
+  passed &= check("applySnapshot",
+                  count(ticks, [&]() { backend.applySnapshot(snapshot); },
+                        [&]() {
+                          snapshot["position"] = playing.elapsed() / 1000.0;
+                        }),
+                  0, ticks);
+
+  QString seek = QStringLiteral("__qwf.seek(-10.000)");
+  passed &= check(
+      "callController<Seek>",
+      count(ticks,
+            [&]() { backend.callWith<ControllerCall::Seek>(-10); },
+            settle),
+      count(ticks, [&]() { page->runJavaScript(seek, world); }, settle),
+      ticks);
+
+  QString setVolume = QStringLiteral("__qwf.setVolume(0.500000)");
+  passed &= check(
+      "callController<SetVolume>",
+      count(ticks,
+            [&]() { backend.callWith<ControllerCall::SetVolume>(0.5); },
+            settle),
+      count(ticks, [&]() { page->runJavaScript(setVolume, world); }, settle),
+      ticks);
+
+  return passed ? 0 : 1;
+}
+
+#include "main.moc"
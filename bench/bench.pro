@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS = interceptor \
+          playback \
+          mprisstress \
+          scriptcache \
+          allocations
@@ -0,0 +1,15 @@
+# Fixture server, MPRIS client and measurement helpers shared by the
+# benchmarks that run the application against ../fixtures.
+
+QT += dbus
+
+SOURCES += $$PWD/fixtures.cpp \
+           $$PWD/measure.cpp \
+           $$PWD/mprisclient.cpp
+HEADERS += $$PWD/fixtures.h \
+           $$PWD/measure.h \
+           $$PWD/mprisclient.h
+
+INCLUDEPATH += $$PWD
+
+DEFINES += FIXTURE_DIR=\\\"$$PWD/../fixtures\\\"
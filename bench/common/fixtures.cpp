@@ -0,0 +1,132 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSettings>
+#include <QTcpSocket>
+#include <QWebEngineScript>
+
+#include "fixtures.h"
+
+QUrl Fixture::url(quint16 port) const {
+  return QUrl(QStringLiteral("http://%1:%2/%3").arg(host).arg(port).arg(page));
+}
+
+QVector<Fixture> fixtures() {
+  return {
+      {"netflix", "netflix.localhost", "netflix.html",
+       QWebEngineScript::MainWorld,
+       QJsonObject{{"name", "netflix"},
+                   {"hosts", QJsonArray{"netflix.localhost"}},
+                   {"interface", "netflix"},
+                   {"controller", ":/scripts/netflix.js"},
+                   {"world", "main"},
+                   {"pollInterval", 1000},
+                   {"trackIdPrefix", "/com/netflix/title/"},
+                   {"identity", "Netflix"}}},
+      {"amazon", "amazon.localhost", "amazon.html",
+       QWebEngineScript::ApplicationWorld,
+       QJsonObject{
+           {"name", "amazon"},
+           {"hosts", QJsonArray{"amazon.localhost"}},
+           {"selectors",
+            QJsonObject{{"title", QJsonArray{"div.title", "div.subtitle"}},
+                        {"nid", "offsetParent"},
+                        {"art", QJsonArray{"div.av-fallback-packshot > *"}}}},
+           {"positionOffset", -10},
+           {"trackIdPrefix", "/com/Amazon/title/"},
+           {"identity", "Amazon Prime Video"}}},
+      {"video", "video.localhost", "video.html",
+       QWebEngineScript::ApplicationWorld, QJsonObject()},
+  };
+}
+
+Fixture fixture(const QString &name) {
+  for (const auto &fixture : fixtures()) {
+    if (fixture.name == name) {
+      return fixture;
+    }
+  }
+  return Fixture();
+}
+
+FixtureServer::FixtureServer(const QString &root) : m_root(root) {
+  QObject::connect(&m_server, &QTcpServer::newConnection, [this]() {
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+      QObject::connect(socket, &QTcpSocket::disconnected, socket,
+                       &QObject::deleteLater);
+      QObject::connect(socket, &QTcpSocket::readyRead,
+                       [this, socket]() { serve(socket); });
+    }
+  });
+}
+
+bool FixtureServer::listen() {
+  return m_server.listen(QHostAddress::LocalHost);
+}
+
+quint16 FixtureServer::port() const { return m_server.serverPort(); }
+
+QStringList FixtureServer::requested() const { return m_requested; }
+
+void FixtureServer::serve(QTcpSocket *socket) {
+  QByteArray request = socket->peek(socket->bytesAvailable());
+  if (!request.contains("\r\n\r\n")) {
+    return;
+  }
+  socket->readAll();
+
+  // GET /path HTTP/1.1
+  QList<QByteArray> line = request.left(request.indexOf('\r')).split(' ');
+  QString path = line.value(1).split('?').first();
+  m_requested.append(path);
+  QFile file(m_root + path);
+
+  QByteArray response;
+  if (path.contains("..") || !file.open(QIODevice::ReadOnly)) {
+    response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+  } else {
+    QByteArray body = file.readAll();
+    QByteArray type = path.endsWith(".html") ? "text/html; charset=utf-8"
+                      : path.endsWith(".js") ? "application/javascript"
+                      : path.endsWith(".png") ? "image/png"
+                                             : "application/octet-stream";
+    response = "HTTP/1.0 200 OK\r\nContent-Type: " + type +
+               "\r\nContent-Length: " + QByteArray::number(body.size()) +
+               "\r\nCache-Control: no-store\r\n\r\n" + body;
+  }
+  socket->write(response);
+  socket->disconnectFromHost();
+}
+
+void useHome(const QString &home) {
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(home + "/config"));
+  qputenv("XDG_CACHE_HOME", QFile::encodeName(home + "/cache"));
+  qputenv("XDG_DATA_HOME", QFile::encodeName(home + "/data"));
+}
+
+bool writeFixtureSettings() {
+  QSettings appSettings("Qtwebflix", "qtwebflix");
+  QSettings stateSettings("Qtwebflix", "Save State");
+  appSettings.setValue("site", "about:blank");
+  stateSettings.setValue("site", "about:blank");
+
+  QJsonArray providers;
+  for (const auto &fixture : fixtures()) {
+    if (!fixture.provider.isEmpty()) {
+      providers.append(fixture.provider);
+    }
+  }
+
+  QSaveFile file(QFileInfo(appSettings.fileName()).absolutePath() +
+                 "/providers.json");
+  return file.open(QIODevice::WriteOnly) &&
+         file.write(QJsonDocument(QJsonObject{{"providers", providers}})
+                        .toJson()) >= 0 &&
+         file.commit();
+}
+
+QString fixtureArtUrl(quint16 port) {
+  return QStringLiteral("http://netflix.localhost:%1/art.png").arg(port);
+}
@@ -0,0 +1,58 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QTcpServer>
+#include <QUrl>
+#include <QVector>
+
+class QTcpSocket;
+
+// A local stand-in for a provider's player page, see ../fixtures.
+struct Fixture {
+  QString name;
+  QString host;
+  QString page;
+  quint32 world;
+  // Bench definition of the provider, pointing it at `host`. Empty for
+  // pages left to the default provider.
+  QJsonObject provider;
+
+  QUrl url(quint16 port) const;
+};
+
+QVector<Fixture> fixtures();
+// The fixture called `name`, a default constructed one if there is none.
+Fixture fixture(const QString &name);
+
+// Serves files from one directory over HTTP/1.0, one request per
+// connection.
+class FixtureServer {
+public:
+  explicit FixtureServer(const QString &root);
+
+  bool listen();
+  quint16 port() const;
+  // Paths requested so far, in order.
+  QStringList requested() const;
+
+private:
+  void serve(QTcpSocket *socket);
+
+  QString m_root;
+  QTcpServer m_server;
+  QStringList m_requested;
+};
+
+// Points settings, caches and the browser profile at `home`, which has to
+// happen before the application object exists.
+void useHome(const QString &home);
+// Writes the settings of a fresh user that opens about:blank and has the
+// fixture providers. Title art for the Netflix stand-in has to be added
+// once MainWindow exists, see fixtureArtUrl().
+bool writeFixtureSettings();
+QString fixtureArtUrl(quint16 port);
+
+#endif // FIXTURES_H
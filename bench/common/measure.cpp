@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <memory>
+
+#include <QEventLoop>
+#include <QTimer>
+#include <QWebEnginePage>
+
+#include "measure.h"
+
+bool wait(int ms, const std::function<void(std::function<void()>)> &start) {
+  // Shared with the callback, which may still be called after a timeout.
+  struct State {
+    QEventLoop *loop = nullptr;
+    bool finished = false;
+  };
+  auto state = std::make_shared<State>();
+
+  QEventLoop loop;
+  QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+  start([state]() {
+    state->finished = true;
+    if (state->loop) {
+      state->loop->quit();
+    }
+  });
+  if (!state->finished) {
+    state->loop = &loop;
+    loop.exec();
+    state->loop = nullptr;
+  }
+  return state->finished;
+}
+
+QVariant runScript(QWebEnginePage *page, const QString &script, quint32 world,
+                   int ms) {
+  // Outlives a timeout, the result may still come in afterwards.
+  auto result = std::make_shared<QVariant>();
+  wait(ms, [&](std::function<void()> done) {
+    page->runJavaScript(script, world, [result, done](const QVariant &value) {
+      *result = value;
+      done();
+    });
+  });
+  return *result;
+}
+
+QJsonObject summarize(QVector<qint64> samples, int lost) {
+  QJsonObject result{{"samples", samples.size()}, {"lost", lost}};
+  if (samples.isEmpty()) {
+    return result;
+  }
+  std::sort(samples.begin(), samples.end());
+  qint64 total = 0;
+  for (qint64 sample : samples) {
+    total += sample;
+  }
+  auto percentile = [&](int p) {
+    return static_cast<double>(samples[(samples.size() - 1) * p / 100]);
+  };
+  result["p50Us"] = percentile(50);
+  result["p99Us"] = percentile(99);
+  result["meanUs"] = static_cast<double>(total / samples.size());
+  result["maxUs"] = static_cast<double>(samples.last());
+  return result;
+}
@@ -0,0 +1,25 @@
+#ifndef MEASURE_H
+#define MEASURE_H
+
+#include <functional>
+
+#include <QJsonObject>
+#include <QVariant>
+#include <QVector>
+
+class QWebEnginePage;
+
+// Runs the event loop until the callback handed to `start` is called or
+// `ms` have passed, returns whether it was called.
+bool wait(int ms, const std::function<void(std::function<void()>)> &start);
+
+// Runs `script` in `world` of `page` and returns its result, invalid if
+// none came within `ms`.
+QVariant runScript(QWebEnginePage *page, const QString &script, quint32 world,
+                   int ms);
+
+// Sample count, p50, p99, mean and max of `samples` in microseconds, with
+// `lost` counting the samples that never completed.
+QJsonObject summarize(QVector<qint64> samples, int lost = 0);
+
+#endif // MEASURE_H
@@ -0,0 +1,73 @@
+#include <memory>
+
+#include <QDBusArgument>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QDBusVariant>
+
+#include "measure.h"
+#include "mprisclient.h"
+
+MprisClient::MprisClient(const QString &name, QObject *parent)
+    : QObject(parent), m_name(name),
+      m_bus(QDBusConnection::connectToBus(QDBusConnection::SessionBus,
+                                          name)) {
+  if (m_bus.isConnected()) {
+    m_bus.connect(mprisService, mprisPath, propertiesInterface,
+                  "PropertiesChanged", this,
+                  SLOT(busPropertiesChanged(QString, QVariantMap,
+                                            QStringList)));
+    m_bus.connect(mprisService, mprisPath, mprisPlayer, "Seeked", this,
+                  SIGNAL(seeked(qlonglong)));
+  }
+}
+
+MprisClient::~MprisClient() { QDBusConnection::disconnectFromBus(m_name); }
+
+bool MprisClient::isConnected() const { return m_bus.isConnected(); }
+
+QDBusPendingCall MprisClient::call(const QString &method,
+                                   const QVariantList &arguments) {
+  QDBusMessage message = QDBusMessage::createMethodCall(
+      mprisService, mprisPath, mprisPlayer, method);
+  message.setArguments(arguments);
+  return m_bus.asyncCall(message);
+}
+
+QString MprisClient::trackId(int timeout) {
+  QDBusMessage message = QDBusMessage::createMethodCall(
+      mprisService, mprisPath, propertiesInterface, "Get");
+  message << QString(mprisPlayer) << QString("Metadata");
+
+  // Outlives a timeout, the reply may still come in afterwards.
+  auto reply = std::make_shared<QDBusMessage>();
+  wait(timeout, [&](std::function<void()> done) {
+    auto watcher = new QDBusPendingCallWatcher(m_bus.asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [reply, done](QDBusPendingCallWatcher *watcher) {
+              *reply = watcher->reply();
+              watcher->deleteLater();
+              done();
+            });
+  });
+
+  QVariantMap metadata;
+  if (!reply->arguments().isEmpty()) {
+    QVariant value = reply->arguments()[0].value<QDBusVariant>().variant();
+    metadata = qdbus_cast<QVariantMap>(value.value<QDBusArgument>());
+  }
+  QVariant id = metadata.value("mpris:trackid");
+  if (id.userType() == qMetaTypeId<QDBusObjectPath>()) {
+    return id.value<QDBusObjectPath>().path();
+  }
+  return id.toString().isEmpty() ? QString(noTrack) : id.toString();
+}
+
+void MprisClient::busPropertiesChanged(const QString &interface,
+                                       const QVariantMap &changed,
+                                       const QStringList &) {
+  if (interface == mprisPlayer) {
+    emit propertiesChanged(changed);
+  }
+}
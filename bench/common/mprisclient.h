@@ -0,0 +1,50 @@
+#ifndef MPRISCLIENT_H
+#define MPRISCLIENT_H
+
+#include <QDBusConnection>
+#include <QDBusPendingCall>
+#include <QObject>
+#include <QVariantList>
+#include <QVariantMap>
+
+// Where qtwebflix publishes its player.
+const char mprisService[] = "org.mpris.MediaPlayer2.QtWebFlix";
+const char mprisPath[] = "/org/mpris/MediaPlayer2";
+const char mprisPlayer[] = "org.mpris.MediaPlayer2.Player";
+const char propertiesInterface[] = "org.freedesktop.DBus.Properties";
+const char noTrack[] = "/org/mpris/MediaPlayer2/TrackList/NoTrack";
+
+// Talks to the player over its own session bus connection, so that calls
+// and signals go through the bus daemon like a media key daemon's would.
+class MprisClient : public QObject {
+  Q_OBJECT
+
+public:
+  // `name` names the bus connection and has to be unique in the process.
+  explicit MprisClient(const QString &name, QObject *parent = nullptr);
+  ~MprisClient();
+
+  bool isConnected() const;
+
+  // Calls `method` of the Player interface without waiting for the reply.
+  QDBusPendingCall call(const QString &method,
+                        const QVariantList &arguments = QVariantList());
+  // TrackId of the current metadata, as SetPosition needs it. NoTrack if
+  // there is none or no reply came within `timeout` ms.
+  QString trackId(int timeout);
+
+signals:
+  // Changed properties of the Player interface.
+  void propertiesChanged(const QVariantMap &changed);
+  void seeked(qlonglong position);
+
+private slots:
+  void busPropertiesChanged(const QString &interface,
+                            const QVariantMap &changed, const QStringList &);
+
+private:
+  QString m_name;
+  QDBusConnection m_bus;
+};
+
+#endif // MPRISCLIENT_H
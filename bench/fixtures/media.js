@@ -0,0 +1,38 @@
+// Gives every <video data-fixture> on the page a few seconds of silence to
+// loop, generated here so that the fixtures need neither network nor media
+// files. Silence is all the controllers and the bridge need to see real
+// playing, timeupdate and seeked events.
+(function () {
+  var rate = 8000, seconds = 30;
+  var samples = rate * seconds;
+  var buffer = new ArrayBuffer(44 + samples);
+  var view = new DataView(buffer);
+
+  function text(offset, value) {
+    for (var i = 0; i < value.length; ++i)
+      view.setUint8(offset + i, value.charCodeAt(i));
+  }
+
+  // 8 bit mono PCM, where silence is 128.
+  text(0, 'RIFF');
+  view.setUint32(4, 36 + samples, true);
+  text(8, 'WAVEfmt ');
+  view.setUint32(16, 16, true);
+  view.setUint16(20, 1, true);
+  view.setUint16(22, 1, true);
+  view.setUint32(24, rate, true);
+  view.setUint32(28, rate, true);
+  view.setUint16(32, 1, true);
+  view.setUint16(34, 8, true);
+  text(36, 'data');
+  view.setUint32(40, samples, true);
+  new Uint8Array(buffer, 44).fill(128);
+
+  var url = URL.createObjectURL(new Blob([buffer], { type: 'audio/wav' }));
+  var videos = document.querySelectorAll('video[data-fixture]');
+  for (var i = 0; i < videos.length; ++i) {
+    videos[i].loop = true;
+    videos[i].src = url;
+    videos[i].play();
+  }
+})();
@@ -0,0 +1,13 @@
+// Stand-in for the redirected Netflix playercore, used to exercise the local
+// script cache offline. bench/scriptcache redirects player.html's
+// /player/playercore.js to it; to try it in the application, point an
+// interceptor rule at it:
+//
+//   [interceptor]
+//   rules/size=1
+//   rules/1/name=netflix-1080p
+//   rules/1/host=assets.nflxext.com
+//   rules/1/path=/ffe/player/html/
+//   rules/1/redirect=file:///path/to/bench/fixtures/playercore.js
+window.__qwfPlayercoreFixture = true;
+console.log('qtwebflix: playercore fixture loaded');
@@ -0,0 +1,19 @@
+QT = core
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = interceptorbench
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += main.cpp \
+           ../../src/urlrules.cpp
+HEADERS += ../../src/urlrules.h
+
+INCLUDEPATH += ../../src
+
+DISTFILES += urls.txt \
+             filters.txt \
+             cases.txt
@@ -0,0 +1,136 @@
+// Replays a list of captured request URLs through the interceptor's rule
+// matching and reports the cost per request, next to the single QRegExp
+// the interceptor used before for comparison. Given a cases file, it also
+// checks what each rule set decides for the URLs in it, see cases.txt for
+// the ones covering filters.txt.
+//
+// Usage: interceptorbench [urls.txt] [rounds] [settings.conf] [filters.txt]
+//                         [cases.txt]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegExp>
+#include <QSettings>
+#include <QTextStream>
+#include <QUrl>
+#include <QVector>
+
+#include "urlrules.h"
+
+namespace {
+
+QVector<QUrl> readUrls(const QString &path) {
+  QVector<QUrl> urls;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return urls;
+  }
+  QTextStream in(&file);
+  while (!in.atEnd()) {
+    QString line = in.readLine().trimmed();
+    if (!line.isEmpty() && !line.startsWith('#')) {
+      urls.append(QUrl(line));
+    }
+  }
+  return urls;
+}
+
+template <typename Match>
+void run(const char *name, const QVector<QUrl> &urls, int rounds,
+         Match match) {
+  int hits = 0;
+  QElapsedTimer timer;
+  timer.start();
+  for (int round = 0; round < rounds; ++round) {
+    for (const QUrl &url : urls) {
+      if (match(url)) {
+        ++hits;
+      }
+    }
+  }
+  qint64 elapsed = timer.nsecsElapsed();
+  qint64 requests = static_cast<qint64>(urls.size()) * rounds;
+
+  QTextStream(stdout) << name << ": " << elapsed / requests << " ns/request, "
+                      << hits / rounds << " of " << urls.size()
+                      << " requests matched\n";
+}
+
+// Checks the lines `block|allow|pass <url>` of `path` against `rules`.
+// Returns false if any of them fails or none could be read.
+bool checkCases(const UrlRuleSet &rules, const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QTextStream(stderr) << "Could not read " << path << "\n";
+    return false;
+  }
+
+  bool passed = true;
+  QTextStream in(&file);
+  while (!in.atEnd()) {
+    QString line = in.readLine().trimmed();
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    QString expected = line.section(' ', 0, 0);
+    QString url = line.section(' ', 1).trimmed();
+
+    int index = rules.match(QUrl(url));
+    QString actual = "pass";
+    if (index >= 0) {
+      actual = rules.rule(index).action == UrlRule::Allow ? "allow" : "block";
+    }
+    bool ok = actual == expected;
+    QTextStream(stdout) << (ok ? "PASS " : "FAIL ") << expected << " " << url
+                        << (ok ? QString() : " (got " + actual + ")") << "\n";
+    passed &= ok;
+  }
+  return passed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QStringList args = app.arguments();
+
+  QString urlsPath = args.value(1, "urls.txt");
+  int rounds = args.value(2, "2000").toInt();
+
+  QVector<QUrl> urls = readUrls(urlsPath);
+  if (urls.isEmpty() || rounds <= 0) {
+    QTextStream(stderr) << "No URLs read from " << urlsPath << "\n";
+    return 1;
+  }
+
+  UrlRuleSet rules;
+  if (args.size() > 3) {
+    QSettings settings(args[3], QSettings::IniFormat);
+    rules.load(settings);
+  } else {
+    rules = UrlRuleSet::defaults();
+  }
+  if (args.size() > 4) {
+    rules.loadFilterList(args[4]);
+  }
+
+  if (args.size() > 5 && !checkCases(rules, args[5])) {
+    return 1;
+  }
+
+  QTextStream(stdout) << urls.size() << " URLs, " << rules.size()
+                      << " rules, " << rounds << " rounds\n";
+
+  run("rule set", urls, rounds,
+      [&](const QUrl &url) { return rules.match(url) >= 0; });
+
+  const QRegExp legacy(
+      R"(.*\:\/\/assets\.nflxext\.com\/.*\/ffe\/player\/html\/.*|)"
+      R"(.*\:\/\/www\.assets\.nflxext\.com\/.*\/ffe\/player\/html\/.*)");
+  run("legacy regexp", urls, rounds, [&](const QUrl &url) {
+    return legacy.exactMatch(url.toString());
+  });
+
+  return 0;
+}
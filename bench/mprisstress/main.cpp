@@ -0,0 +1,427 @@
+// Drives the MPRIS player the way KDE Connect or Plasma do, over the session
+// bus, against a local provider stand-in from ../fixtures. PlayPause,
+// SetPosition and Seek are sent at each of the given rates and for every run
+// it reports:
+//
+//   - latency from the call to the state change it caused coming back over
+//     the bus (PlaybackStatus, or Seeked), p50 and p99
+//   - calls whose change was never seen, either because a later call
+//     superseded it or because it got lost
+//   - merged calls: seeks and positions that MprisInterface deliberately
+//     folded into a later command, from its CommandQueue
+//   - lost commands: calls the <video> never acted on, counted from its
+//     play, pause and seeking events, less the merged ones
+//   - whether the final state matches the last call
+//   - main thread stalls, as lateness of a 5 ms timer on the thread that
+//     runs MprisInterface
+//
+// The probe has its own bus connection, so calls and signals go through the
+// bus daemon. Run it under `dbus-run-session` to keep it away from the
+// desktop's media players:
+//
+//   dbus-run-session -- ./mprisstressbench stress.json 1,10,100,1000
+//
+// Usage: mprisstressbench [results.json] [rates per second] [calls per run]
+//                         [fixture] [fixtures dir]
+
+#include <functional>
+
+#include <QApplication>
+#include <QDBusObjectPath>
+#include <QDBusPendingCallWatcher>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QWebEngineScript>
+#include <QWebEngineSettings>
+#include <QWebEngineView>
+
+#include "fixtures.h"
+#include "mainwindow.h"
+#include "measure.h"
+#include "mprisclient.h"
+#include "scriptcache.h"
+
+namespace {
+
+// Give up on a page or call after this many milliseconds.
+const int timeout = 30000;
+// Time for the last calls of a run to take effect.
+const int settleTime = 3000;
+
+// Seeked positions within this many microseconds of a SetPosition target
+// are attributed to it.
+const qlonglong positionTolerance = 1000 * 1000;
+
+// Interval of the stall watch and the lateness counted as a stall, in
+// milliseconds.
+const int stallInterval = 5;
+const int stallThreshold = 50;
+
+// Counts the media events the <video> elements fire. Installed in the
+// application world, which sees the page's DOM events without the page
+// seeing the counters.
+const char eventCounters[] = R"(
+  (function () {
+    if (!window.__stress) {
+      window.__stress = {};
+      ['play', 'pause', 'seeking'].forEach(function (type) {
+        document.addEventListener(type, function () {
+          ++window.__stress[type];
+        }, true);
+      });
+    }
+    window.__stress.play = window.__stress.pause = 0;
+    window.__stress.seeking = 0;
+  })()
+)";
+
+} // namespace
+
+// Measures how late a short timer fires on the main thread, where the
+// MPRIS adaptor, MprisInterface and the page callbacks all run.
+class StallWatch : public QObject {
+  Q_OBJECT
+
+public:
+  explicit StallWatch(QObject *parent = nullptr) : QObject(parent) {
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(stallInterval);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+  }
+
+  void start() {
+    m_lateness.clear();
+    m_clock.start();
+    m_last = 0;
+    m_timer.start();
+  }
+
+  QJsonObject stop() {
+    m_timer.stop();
+    int stalls = 0;
+    for (qint64 lateness : m_lateness) {
+      if (lateness >= stallThreshold * 1000) {
+        ++stalls;
+      }
+    }
+    QJsonObject result = summarize(m_lateness);
+    result["stalls"] = stalls;
+    return result;
+  }
+
+private slots:
+  void tick() {
+    qint64 now = m_clock.nsecsElapsed() / 1000;
+    m_lateness.append(qMax<qint64>(now - m_last - stallInterval * 1000, 0));
+    m_last = now;
+  }
+
+private:
+  QTimer m_timer;
+  QElapsedTimer m_clock;
+  qint64 m_last = 0;
+  QVector<qint64> m_lateness;
+};
+
+// Sends calls over its own bus connection and attributes the state changes
+// coming back to them.
+class StressProbe : public QObject {
+  Q_OBJECT
+
+public:
+  // What a call is expected to change.
+  struct Expectation {
+    QString status;
+    // For SetPosition, the target in microseconds.
+    qlonglong position = -1;
+    // For Seek, matched to Seeked signals in order.
+    bool relative = false;
+  };
+
+  explicit StressProbe(QObject *parent = nullptr)
+      : QObject(parent), m_client("mprisstressbench") {
+    m_clock.start();
+    connect(&m_client, SIGNAL(propertiesChanged(QVariantMap)), this,
+            SLOT(propertiesChanged(QVariantMap)));
+    connect(&m_client, SIGNAL(seeked(qlonglong)), this,
+            SLOT(seeked(qlonglong)));
+  }
+
+  bool isConnected() const { return m_client.isConnected(); }
+
+  void reset() {
+    m_pending.clear();
+    m_latencies.clear();
+    m_superseded = 0;
+    m_errors = 0;
+  }
+
+  void call(const QString &method, const QVariantList &arguments,
+            const Expectation &expectation) {
+    m_pending.append({m_clock.nsecsElapsed() / 1000, expectation});
+
+    auto watcher =
+        new QDBusPendingCallWatcher(m_client.call(method, arguments), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this](QDBusPendingCallWatcher *watcher) {
+              if (watcher->isError()) {
+                ++m_errors;
+              }
+              watcher->deleteLater();
+            });
+  }
+
+  // TrackId of the current metadata, needed by SetPosition.
+  QString trackId() { return m_client.trackId(timeout); }
+
+  const QVector<qint64> &latencies() const { return m_latencies; }
+  // Calls whose change was never seen.
+  int unobserved() const { return m_superseded + m_pending.size(); }
+  int errors() const { return m_errors; }
+
+private slots:
+  void propertiesChanged(const QVariantMap &changed) {
+    if (!changed.contains("PlaybackStatus")) {
+      return;
+    }
+    QString status = changed.value("PlaybackStatus").toString();
+    match([&](const Expectation &e) { return e.status == status; });
+  }
+
+  void seeked(qlonglong position) {
+    match([&](const Expectation &e) {
+      return e.relative || (e.position >= 0 && qAbs(e.position - position) <
+                                                   positionTolerance);
+    });
+  }
+
+private:
+  struct Pending {
+    qint64 sent;
+    Expectation expectation;
+  };
+
+  // Attributes a change to the oldest call that expects it. Older calls
+  // are taken as superseded, their change was folded into this one.
+  void match(const std::function<bool(const Expectation &)> &expects) {
+    for (int i = 0; i < m_pending.size(); ++i) {
+      if (expects(m_pending[i].expectation)) {
+        m_latencies.append(m_clock.nsecsElapsed() / 1000 - m_pending[i].sent);
+        m_superseded += i;
+        m_pending.remove(0, i + 1);
+        return;
+      }
+    }
+  }
+
+  MprisClient m_client;
+  QElapsedTimer m_clock;
+  QVector<Pending> m_pending;
+  QVector<qint64> m_latencies;
+  int m_superseded = 0;
+  int m_errors = 0;
+};
+
+namespace {
+
+// Sends `count` calls of `method`, one every 1000 / `rate` ms, and reports
+// what came of them.
+QJsonObject stress(const QString &method, int rate, int count,
+                   MainWindow &w, const Fixture &fixture, StressProbe &probe,
+                   StallWatch &stalls) {
+  const QString snapshot = QStringLiteral("__qwf.snapshot()");
+  QWebEnginePage *page = w.webView()->page();
+
+  // Start every run from a playing video and zeroed counters.
+  runScript(page, "__qwf.play()", fixture.world, timeout);
+  wait(1000, [](std::function<void()>) {});
+  runScript(page, eventCounters, QWebEngineScript::ApplicationWorld, timeout);
+  bool playing =
+      runScript(page, snapshot, fixture.world, timeout).toMap()["state"] ==
+      "playing";
+  QString trackId = method == "SetPosition" ? probe.trackId() : QString();
+  probe.reset();
+  const CommandQueue &commands = w.mprisInterface()->commands();
+  qint64 merged = commands.sent() - commands.received();
+
+  int sent = 0;
+  QString status = playing ? "Playing" : "Paused";
+  qlonglong target = 0;
+
+  QTimer pacer;
+  pacer.setTimerType(Qt::PreciseTimer);
+  pacer.setInterval(1000 / rate);
+  QObject::connect(&pacer, &QTimer::timeout, [&]() {
+    StressProbe::Expectation expectation;
+    if (method == "PlayPause") {
+      status = status == "Playing" ? "Paused" : "Playing";
+      expectation.status = status;
+      probe.call(method, {}, expectation);
+    } else if (method == "SetPosition") {
+      // Distinct targets within the fixture's 30 s of media.
+      target = (2 + sent * 3 % 24) * 1000000LL;
+      expectation.position = target;
+      probe.call(method,
+                 {QVariant::fromValue(QDBusObjectPath(trackId)),
+                  QVariant::fromValue(target)},
+                 expectation);
+    } else {
+      expectation.relative = true;
+      probe.call(method, {QVariant::fromValue(sent % 2 ? -2000000LL
+                                                       : 2000000LL)},
+                 expectation);
+    }
+    if (++sent == count) {
+      pacer.stop();
+    }
+  });
+
+  stalls.start();
+  QElapsedTimer elapsed;
+  elapsed.start();
+  pacer.start();
+  wait(count * 1000 / rate + timeout, [&](std::function<void()> done) {
+    QObject::connect(&pacer, &QTimer::timeout, [&pacer, done]() {
+      if (!pacer.isActive()) {
+        done();
+      }
+    });
+  });
+  qint64 sendMs = elapsed.elapsed();
+  wait(settleTime, [](std::function<void()>) {});
+  QJsonObject stallResult = stalls.stop();
+  merged += commands.received() - commands.sent();
+
+  QVariantMap events =
+      runScript(page, "window.__stress", QWebEngineScript::ApplicationWorld,
+                timeout)
+          .toMap();
+  QVariantMap state = runScript(page, snapshot, fixture.world, timeout).toMap();
+
+  int applied;
+  bool finalState;
+  if (method == "PlayPause") {
+    applied = events["play"].toInt() + events["pause"].toInt();
+    finalState = (state["state"] == "playing") == (status == "Playing");
+  } else {
+    applied = events["seeking"].toInt();
+    finalState = method != "SetPosition" ||
+                 qAbs(state["position"].toDouble() * 1e6 - target) <
+                     positionTolerance + settleTime * 1000LL;
+  }
+
+  return QJsonObject{{"method", method},
+                     {"rate", rate},
+                     {"sent", sent},
+                     {"sendMs", sendMs},
+                     {"errors", probe.errors()},
+                     {"latency", summarize(probe.latencies())},
+                     {"unobserved", probe.unobserved()},
+                     {"applied", applied},
+                     {"merged", merged},
+                     {"lost", qMax<qint64>(sent - merged - applied, 0)},
+                     {"finalState", finalState},
+                     {"mainThread", stallResult}};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  // Settings, caches and the browser profile of a fresh user.
+  QTemporaryDir home;
+  useHome(home.path());
+
+  ScriptCache::registerScheme();
+  QApplication app(argc, argv);
+  QStringList args = app.arguments();
+
+  QString resultsPath = args.value(1, "stress.json");
+  QList<int> rates;
+  for (const auto &rate : args.value(2, "1,10,100,1000").split(',')) {
+    if (rate.toInt() > 0) {
+      rates.append(rate.toInt());
+    }
+  }
+  int count = args.value(3, "50").toInt();
+  Fixture fixture = ::fixture(args.value(4, "netflix"));
+  QString fixtureDir = args.value(5, FIXTURE_DIR);
+
+  FixtureServer server(fixtureDir);
+  if (!home.isValid() || !server.listen() || rates.isEmpty() || count <= 0 ||
+      fixture.name.isEmpty()) {
+    QTextStream(stderr) << "Could not set up the fixtures from " << fixtureDir
+                        << "\n";
+    return 1;
+  }
+  if (!writeFixtureSettings()) {
+    QTextStream(stderr) << "Could not write the settings to " << home.path()
+                        << "\n";
+    return 1;
+  }
+
+  QWebEngineSettings::globalSettings()->setAttribute(
+      QWebEngineSettings::PlaybackRequiresUserGesture, false);
+
+  MainWindow w;
+  w.show();
+  w.artCache()->insert("80000002", fixtureArtUrl(server.port()),
+                       "Fixture Series");
+
+  StressProbe probe;
+  if (!probe.isConnected()) {
+    QTextStream(stderr) << "No session bus, run under dbus-run-session\n";
+    return 1;
+  }
+
+  QUrl url = fixture.url(server.port());
+  bool playing = wait(timeout, [&](std::function<void()> done) {
+    QObject::connect(w.videoBridge(), &VideoBridge::videoStateChanged, &probe,
+                     [done](const QString &type) {
+                       if (type == "playing") {
+                         done();
+                       }
+                     });
+    w.webView()->setUrl(url);
+  });
+  QObject::disconnect(w.videoBridge(), nullptr, &probe, nullptr);
+  if (!playing) {
+    QTextStream(stderr) << url.toString() << " did not start playing\n";
+    return 1;
+  }
+
+  StallWatch stalls;
+  QJsonArray runs;
+  for (const auto &method : {"PlayPause", "SetPosition", "Seek"}) {
+    for (int rate : rates) {
+      QTextStream(stdout) << method << " at " << rate << "/s...\n";
+      runs.append(stress(method, rate, count, w, fixture, probe, stalls));
+    }
+  }
+
+  QJsonObject report{{"platform", QGuiApplication::platformName()},
+                     {"fixture", fixture.name},
+                     {"calls", count},
+                     {"runs", runs}};
+  QByteArray json = QJsonDocument(report).toJson();
+
+  QSaveFile file(resultsPath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(json) < 0 ||
+      !file.commit()) {
+    QTextStream(stderr) << "Could not write " << resultsPath << "\n";
+    return 1;
+  }
+  QTextStream(stdout) << json;
+  return 0;
+}
+
+#include "main.moc"
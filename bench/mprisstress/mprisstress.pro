@@ -0,0 +1,12 @@
+QT += dbus
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = mprisstressbench
+TEMPLATE = app
+
+include(../../src/src.pri)
+include(../common/common.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,293 @@
+// Starts the real MainWindow, normally under the offscreen platform, against
+// local stand-ins for the provider pages in ../fixtures and measures:
+//
+//   - runJavaScript round trips, for a no-op and for a controller snapshot
+//   - MPRIS latency, from a Pause/Play call on the session bus to the
+//     PlaybackStatus change arriving, and calls that never got one
+//   - CPU time and context switches (wakeups) per minute of the whole
+//     process tree, while playing and while paused
+//
+// Nothing leaves the machine: the fixtures are served from 127.0.0.1 under
+// *.localhost names that a bench providers.json maps to the providers, and
+// settings, caches and the browser profile live in a temporary directory.
+// Run it under `dbus-run-session` to get the MPRIS numbers without touching
+// the desktop's media players.
+//
+// Usage: playbackbench [results.json] [rounds] [seconds] [fixtures dir]
+
+#include <functional>
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QWebEngineSettings>
+#include <QWebEngineView>
+
+#include <unistd.h>
+
+#include "fixtures.h"
+#include "mainwindow.h"
+#include "measure.h"
+#include "mprisclient.h"
+#include "scriptcache.h"
+
+namespace {
+
+// Give up on a page, call or state change after this many milliseconds.
+const int timeout = 30000;
+
+// Round trips of `script` in `world`, in microseconds.
+QJsonObject measureRoundTrips(QWebEnginePage *page, const QString &script,
+                              quint32 world, int rounds) {
+  QVector<qint64> samples;
+  int lost = 0;
+  QElapsedTimer timer;
+  for (int i = 0; i < rounds; ++i) {
+    timer.start();
+    bool answered = wait(timeout, [&](std::function<void()> done) {
+      page->runJavaScript(script, world, [done](const QVariant &) { done(); });
+    });
+    if (answered) {
+      samples.append(timer.nsecsElapsed() / 1000);
+    } else {
+      ++lost;
+    }
+  }
+  return summarize(samples, lost);
+}
+
+} // namespace
+
+// Times PlaybackStatus changes caused by calls over the bus.
+class MprisProbe : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MprisProbe(QObject *parent = nullptr)
+      : QObject(parent), m_client("playbackbench") {
+    connect(&m_client, SIGNAL(propertiesChanged(QVariantMap)), this,
+            SLOT(propertiesChanged(QVariantMap)));
+  }
+
+  bool isConnected() const { return m_client.isConnected(); }
+
+  // Calls `method` and waits for PlaybackStatus to become `status`.
+  // Returns the latency in microseconds, -1 if the change never came.
+  qint64 call(const QString &method, const QString &status) {
+    QElapsedTimer timer;
+    timer.start();
+    bool changed = wait(timeout, [&](std::function<void()> done) {
+      m_expected = status;
+      m_changed = done;
+      m_client.call(method);
+    });
+    m_changed = nullptr;
+    return changed ? timer.nsecsElapsed() / 1000 : -1;
+  }
+
+private slots:
+  void propertiesChanged(const QVariantMap &changed) {
+    if (m_changed &&
+        changed.value("PlaybackStatus").toString() == m_expected) {
+      m_changed();
+    }
+  }
+
+private:
+  MprisClient m_client;
+  QString m_expected;
+  std::function<void()> m_changed;
+};
+
+namespace {
+
+QJsonObject measureMpris(MprisProbe &probe, int rounds) {
+  if (!probe.isConnected()) {
+    return QJsonObject();
+  }
+
+  QVector<qint64> samples;
+  int lost = 0;
+  for (int i = 0; i < rounds; ++i) {
+    for (const auto &step : {qMakePair(QStringLiteral("Pause"),
+                                       QStringLiteral("Paused")),
+                             qMakePair(QStringLiteral("Play"),
+                                       QStringLiteral("Playing"))}) {
+      qint64 latency = probe.call(step.first, step.second);
+      if (latency < 0) {
+        ++lost;
+      } else {
+        samples.append(latency);
+      }
+    }
+  }
+  return summarize(samples, lost);
+}
+
+struct Usage {
+  qint64 ticks = 0;
+  qint64 switches = 0;
+};
+
+QByteArray readProc(const QString &path) {
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+// CPU ticks and context switches of this process and its descendants.
+Usage usage() {
+  QHash<qint64, QVector<qint64>> children;
+  QHash<qint64, Usage> byPid;
+  for (const auto &entry :
+       QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+    if (!entry[0].isDigit()) {
+      continue;
+    }
+    QByteArray stat = readProc("/proc/" + entry + "/stat");
+    // pid (comm) state ppid ... utime stime, comm may contain spaces.
+    QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13) {
+      continue;
+    }
+    qint64 pid = entry.toLongLong();
+    children[fields[1].toLongLong()].append(pid);
+    byPid[pid].ticks = fields[11].toLongLong() + fields[12].toLongLong();
+  }
+
+  Usage total;
+  QVector<qint64> pending{static_cast<qint64>(getpid())};
+  while (!pending.isEmpty()) {
+    qint64 pid = pending.takeLast();
+    total.ticks += byPid.value(pid).ticks;
+    QString tasks = QStringLiteral("/proc/%1/task/").arg(pid);
+    for (const auto &tid :
+         QDir(tasks).entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+      for (const auto &line : readProc(tasks + tid + "/status").split('\n')) {
+        if (line.startsWith("voluntary_ctxt_switches:") ||
+            line.startsWith("nonvoluntary_ctxt_switches:")) {
+          total.switches +=
+              line.mid(line.indexOf(':') + 1).trimmed().toLongLong();
+        }
+      }
+    }
+    pending += children.value(pid);
+  }
+  return total;
+}
+
+QJsonObject measureUsage(int seconds) {
+  Usage before = usage();
+  wait(seconds * 1000, [](std::function<void()>) {});
+  Usage after = usage();
+
+  double minutes = seconds / 60.0;
+  return QJsonObject{
+      {"seconds", seconds},
+      {"cpuSecondsPerMinute",
+       (after.ticks - before.ticks) / double(sysconf(_SC_CLK_TCK)) / minutes},
+      {"wakeupsPerMinute", (after.switches - before.switches) / minutes}};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  // Settings, caches and the browser profile of a fresh user.
+  QTemporaryDir home;
+  useHome(home.path());
+
+  ScriptCache::registerScheme();
+  QApplication app(argc, argv);
+  QStringList args = app.arguments();
+
+  QString resultsPath = args.value(1, "playback.json");
+  int rounds = args.value(2, "100").toInt();
+  int seconds = args.value(3, "30").toInt();
+  QString fixtureDir = args.value(4, FIXTURE_DIR);
+
+  FixtureServer server(fixtureDir);
+  if (!home.isValid() || !server.listen() || rounds <= 0 || seconds <= 0) {
+    QTextStream(stderr) << "Could not set up the fixtures from " << fixtureDir
+                        << "\n";
+    return 1;
+  }
+
+  if (!writeFixtureSettings()) {
+    QTextStream(stderr) << "Could not write the settings to " << home.path()
+                        << "\n";
+    return 1;
+  }
+
+  QWebEngineSettings::globalSettings()->setAttribute(
+      QWebEngineSettings::PlaybackRequiresUserGesture, false);
+
+  MainWindow w;
+  w.show();
+  // The stand-in's title id, so that the Netflix backend finds its art
+  // without asking netflix.com.
+  w.artCache()->insert("80000002", fixtureArtUrl(server.port()),
+                       "Fixture Series");
+
+  MprisProbe probe;
+  QJsonArray results;
+  for (const auto &fixture : fixtures()) {
+    QTextStream(stdout) << fixture.name << "...\n";
+    QUrl url = fixture.url(server.port());
+
+    bool playing = wait(timeout, [&](std::function<void()> done) {
+      QObject::connect(w.videoBridge(), &VideoBridge::videoStateChanged,
+                       &probe, [done](const QString &type) {
+                         if (type == "playing") {
+                           done();
+                         }
+                       });
+      w.webView()->setUrl(url);
+    });
+    QObject::disconnect(w.videoBridge(), nullptr, &probe, nullptr);
+    if (!playing) {
+      QTextStream(stderr) << url.toString() << " did not start playing\n";
+      results.append(QJsonObject{{"fixture", fixture.name}, {"error", "load"}});
+      continue;
+    }
+
+    QJsonObject result{{"fixture", fixture.name}};
+    QWebEnginePage *page = w.webView()->page();
+    result["runJavaScript"] = QJsonObject{
+        {"noop", measureRoundTrips(page, "0", fixture.world, rounds)},
+        {"snapshot",
+         measureRoundTrips(page, "window.__qwf ? __qwf.snapshot() : null",
+                           fixture.world, rounds)}};
+    result["mpris"] = measureMpris(probe, rounds / 5 + 1);
+
+    result["active"] = measureUsage(seconds);
+    page->runJavaScript("window.__qwf && __qwf.pause()", fixture.world);
+    result["idle"] = measureUsage(seconds);
+    results.append(result);
+  }
+
+  QJsonObject report{{"platform", QGuiApplication::platformName()},
+                     {"rounds", rounds},
+                     {"fixtures", results}};
+  QByteArray json = QJsonDocument(report).toJson();
+
+  QSaveFile file(resultsPath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(json) < 0 ||
+      !file.commit()) {
+    QTextStream(stderr) << "Could not write " << resultsPath << "\n";
+    return 1;
+  }
+  QTextStream(stdout) << json;
+  return 0;
+}
+
+#include "main.moc"
@@ -0,0 +1,16 @@
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = playbackbench
+TEMPLATE = app
+
+include(../../src/src.pri)
+include(../common/common.pri)
+
+SOURCES += main.cpp
+
+DISTFILES += ../fixtures/netflix.html \
+             ../fixtures/amazon.html \
+             ../fixtures/video.html \
+             ../fixtures/media.js \
+             ../fixtures/art.png
@@ -0,0 +1,151 @@
+// Checks the local script cache end to end, offline. An interceptor rule
+// redirects /player/playercore.js of ../fixtures/player.html to the file://
+// URL of ../fixtures/playercore.js, which the application hands to
+// ScriptCache like any other redirect target. The check passes if:
+//
+//   - the page ran the fixture script
+//   - the fixture server never saw the original request
+//   - qtwebflix:script/playercore serves the fixture's bytes
+//   - the cache directory holds a hashed copy of it
+//
+// Usage: scriptcachebench [fixtures dir]
+
+#include <functional>
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QWebEngineScript>
+#include <QWebEngineSettings>
+#include <QWebEngineView>
+
+#include "commandlineparser.h"
+#include "fixtures.h"
+#include "mainwindow.h"
+#include "measure.h"
+#include "scriptcache.h"
+
+namespace {
+
+// Give up on a page or script after this many milliseconds.
+const int timeout = 30000;
+
+QVariant runScript(QWebEnginePage *page, const QString &script) {
+  return ::runScript(page, script, QWebEngineScript::MainWorld, timeout);
+}
+
+// Evaluates the promise `script` and returns what it resolved to.
+QVariant awaitScript(QWebEnginePage *page, const QString &script) {
+  runScript(page, QStringLiteral("window.__bench = undefined;"
+                                 "Promise.resolve(%1).then("
+                                 "    function (v) { window.__bench = v; },"
+                                 "    function (e) {"
+                                 "      window.__bench = 'error: ' + e;"
+                                 "    });"
+                                 "0")
+                      .arg(script));
+
+  QVariant result;
+  QElapsedTimer elapsed;
+  elapsed.start();
+  while (!result.isValid() && !elapsed.hasExpired(timeout)) {
+    wait(50, [](std::function<void()>) {});
+    result = runScript(page, "window.__bench");
+  }
+  return result;
+}
+
+bool check(const char *what, bool passed) {
+  QTextStream(stdout) << (passed ? "PASS " : "FAIL ") << what << "\n";
+  return passed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  QTemporaryDir home;
+  useHome(home.path());
+
+  ScriptCache::registerScheme();
+  QApplication app(argc, argv);
+  QString fixtureDir = app.arguments().value(1, FIXTURE_DIR);
+  QString fixtureScript = fixtureDir + "/playercore.js";
+
+  FixtureServer server(fixtureDir);
+  if (!home.isValid() || !server.listen() || !QFile::exists(fixtureScript) ||
+      !writeFixtureSettings()) {
+    QTextStream(stderr) << "Could not set up the fixtures from " << fixtureDir
+                        << "\n";
+    return 1;
+  }
+
+  {
+    QSettings settings("Qtwebflix", "qtwebflix");
+    settings.beginGroup("interceptor");
+    settings.beginWriteArray("rules");
+    settings.setArrayIndex(0);
+    settings.setValue("name", "playercore");
+    settings.setValue("host", "video.localhost");
+    settings.setValue("path", "^/player/playercore\\.js");
+    settings.setValue("redirect",
+                      QUrl::fromLocalFile(fixtureScript).toString());
+    settings.endArray();
+    settings.endGroup();
+  }
+
+  // Also names the application, and with it the cache directory.
+  Commandlineparser parser;
+  MainWindow w;
+  w.show();
+  w.parseCommand(parser);
+
+  QUrl url(QStringLiteral("http://video.localhost:%1/player.html")
+               .arg(server.port()));
+  bool loaded = wait(timeout, [&](std::function<void()> done) {
+    QObject::connect(w.webView(), &QWebEngineView::loadFinished, &app,
+                     [done](bool ok) {
+                       if (ok) {
+                         done();
+                       }
+                     });
+    w.webView()->setUrl(url);
+  });
+  if (!loaded) {
+    QTextStream(stderr) << url.toString() << " did not load\n";
+    return 1;
+  }
+
+  QWebEnginePage *page = w.webView()->page();
+  QFile file(fixtureScript);
+  file.open(QIODevice::ReadOnly);
+  QString expected = QString::fromUtf8(file.readAll());
+
+  bool passed = true;
+  passed &= check("fixture script ran in the page",
+                  runScript(page, "window.__qwfPlayercoreFixture === true")
+                      .toBool());
+  passed &= check("original request never reached the server",
+                  !server.requested().contains("/player/playercore.js"));
+  passed &= check("qtwebflix:script/playercore serves the fixture",
+                  awaitScript(page, "fetch('qtwebflix:script/playercore')"
+                                    ".then(function (r) { return r.text(); })")
+                          .toString() == expected);
+  QString cacheDir =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      "/scripts";
+  passed &= check("hashed copy stored in the cache directory",
+                  !QDir(cacheDir)
+                       .entryList({"playercore-*.js"}, QDir::Files)
+                       .isEmpty());
+
+  return passed ? 0 : 1;
+}
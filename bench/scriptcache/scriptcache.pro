@@ -0,0 +1,13 @@
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = scriptcachebench
+TEMPLATE = app
+
+include(../../src/src.pri)
+include(../common/common.pri)
+
+SOURCES += main.cpp
+
+DISTFILES += ../fixtures/player.html \
+             ../fixtures/playercore.js
@@ -4,7 +4,8 @@ CONFIG += ordered
 
 SUBDIRS = qtdbusextended \
           qtmpris \
-          src
+          src \
+          bench
 
 qtdbusextended.file = lib/qtdbusextended.pro
 
@@ -0,0 +1,159 @@
+// Shared part of the per-provider player controllers. Each provider script
+// builds its controller with __qwfController() and installs it as
+// window.__qwf, which MprisInterface drives with short calls such as
+// `__qwf.seek(12.5)` instead of sending whole scripts for every command.
+(function () {
+  if (window.__qwfController) return;
+
+  window.__qwfController = function (options) {
+    // Video elements in the document, kept current by a MutationObserver so
+    // that lookups never have to query the DOM. `active` is the element
+    // commands go to: the one that last started playing, or the best
+    // candidate picked when it goes away.
+    var media = new Set();
+    var active = null;
+
+    function collect(node, callback) {
+      if (node.nodeType !== Node.ELEMENT_NODE) return;
+      if (node.tagName === 'VIDEO') {
+        callback(node);
+        return;
+      }
+      var found = node.getElementsByTagName('video');
+      for (var i = 0; i < found.length; ++i) callback(found[i]);
+    }
+
+    function add(vid) {
+      media.add(vid);
+    }
+
+    function remove(vid) {
+      media.delete(vid);
+      if (vid === active) active = null;
+    }
+
+    // A provider switch without navigation installs another controller
+    // into the same document. Only the newest one keeps its observer and
+    // listener, the previous ones are disconnected here.
+    if (window.__qwfController.hooks) window.__qwfController.hooks.remove();
+
+    var observer = new MutationObserver(function (records) {
+      records.forEach(function (record) {
+        record.removedNodes.forEach(function (node) { collect(node, remove); });
+        record.addedNodes.forEach(function (node) { collect(node, add); });
+      });
+    });
+    observer.observe(document, { childList: true, subtree: true });
+
+    var existing = document.getElementsByTagName('video');
+    for (var i = 0; i < existing.length; ++i) add(existing[i]);
+
+    function playing(event) {
+      if (media.has(event.target) && options.matches(event.target))
+        active = event.target;
+    }
+    // Media events do not bubble, so listen in the capture phase.
+    document.addEventListener('playing', playing, true);
+
+    window.__qwfController.hooks = {
+      remove: function () {
+        observer.disconnect();
+        document.removeEventListener('playing', playing, true);
+      }
+    };
+
+    // Prefers a playing element, then the longest one, so that an idle
+    // trailer does not win over the main feature.
+    function pick() {
+      var best = null;
+      media.forEach(function (vid) {
+        if (!options.matches(vid)) return;
+        if (!best || (best.paused && !vid.paused) ||
+            (best.paused === vid.paused &&
+             (vid.duration || 0) >= (best.duration || 0)))
+          best = vid;
+      });
+      return best;
+    }
+
+    function video() {
+      if (!active || !options.matches(active)) active = pick();
+      return active;
+    }
+
+    // The same states as videobridge.js reports for its events, so that
+    // polled and pushed updates agree on an ended video.
+    function stateOf(vid) {
+      if (!vid || vid.ended) return 'stopped';
+      return vid.paused ? 'paused' : 'playing';
+    }
+
+    function resumeWhenReady(vid) {
+      var timer = setInterval(function () {
+        if (vid.paused && vid.readyState == 4 || !vid.paused) {
+          vid.play();
+          clearInterval(timer);
+        }
+      }, 50);
+    }
+
+    var controller = {
+      provider: options.provider,
+      video: video,
+
+      play: function () {
+        var vid = video();
+        if (vid) vid.play();
+      },
+
+      pause: function () {
+        var vid = video();
+        if (vid) vid.pause();
+      },
+
+      toggle: function () {
+        var vid = video();
+        if (!vid) return;
+        if (vid.paused) vid.play();
+        else vid.pause();
+      },
+
+      setVolume: function (volume) {
+        var vid = video();
+        if (vid) vid.volume = volume;
+      },
+
+      setPosition: function (seconds) {
+        var vid = video();
+        if (!vid) return;
+        vid.pause();
+        vid.currentTime = seconds;
+        resumeWhenReady(vid);
+      },
+
+      seek: function (offset) {
+        var vid = video();
+        if (vid) controller.setPosition(vid.currentTime + offset);
+      },
+
+      snapshot: function () {
+        var vid = video();
+        var snapshot = {
+          state: stateOf(vid),
+          position: vid ? vid.currentTime : -1,
+          duration: vid && isFinite(vid.duration) ? vid.duration : -1,
+          volume: vid ? vid.volume : -1,
+          rate: vid ? vid.playbackRate : -1,
+          title: '',
+          nid: '',
+          arturl: ''
+        };
+        if (options.metadata) options.metadata(vid, snapshot);
+        return snapshot;
+      }
+    };
+
+    if (options.extend) options.extend(controller);
+    return controller;
+  };
+})();
@@ -0,0 +1,89 @@
+// Controller for Netflix. Seeking goes through Netflix's own player API,
+// which is only reachable from the page's main world.
+(function () {
+  if (window.__qwf && window.__qwf.provider === 'netflix') return;
+
+  var nextEpisodeSelector =
+      'button.touchable.PlayerControls--control-element.nfp-button-control.' +
+      'default-control-button.button-nfplayerNextEpisode';
+
+  // A new video element means a new player session, so the player handle is
+  // cached per element.
+  var player = null;
+  var playerVideo = null;
+
+  function netflixPlayer(vid) {
+    if (player && playerVideo === vid) return player;
+    var videoPlayer = netflix.appContext.state.playerApp.getAPI().videoPlayer;
+    var playerSessionId = videoPlayer.getAllPlayerSessionIds()[0];
+    player = videoPlayer.getVideoPlayerBySessionId(playerSessionId);
+    playerVideo = vid;
+    return player;
+  }
+
+  window.__qwf = __qwfController({
+    provider: 'netflix',
+
+    matches: function () {
+      return true;
+    },
+
+    metadata: function (vid, snapshot) {
+      var titleLabel = document.querySelector(
+          '.PlayerControls--control-element.video-title .ellipsize-text');
+      snapshot.title = titleLabel ?
+          titleLabel.innerHTML.replace(/(<([^>]+)>)/g, ' ')
+              .replace(/ +(?= )/g, '').trim() : '';
+      snapshot.nid = vid && vid.offsetParent ? vid.offsetParent.id : '';
+    },
+
+    extend: function (controller) {
+      controller.setPosition = function (seconds) {
+        var vid = controller.video();
+        if (vid) netflixPlayer(vid).seek(seconds * 1000);
+      };
+
+      controller.seek = function (offset) {
+        var vid = controller.video();
+        if (!vid) return;
+        var p = netflixPlayer(vid);
+        p.seek(p.getCurrentTime() + offset * 1000);
+      };
+
+      controller.canGoNext = function () {
+        return !!document.querySelector(nextEpisodeSelector);
+      };
+
+      // Id and title of the episode after the current one, from the player's
+      // own metadata. Used to prefetch its art before it starts.
+      controller.nextEpisode = function () {
+        var next = { canGoNext: controller.canGoNext(), nid: '', title: '' };
+        try {
+          var vid = controller.video();
+          var current = vid && vid.offsetParent ? vid.offsetParent.id : '';
+          var metadata = netflix.appContext.state.playerApp.getState()
+              .videoPlayer.videoMetadata[current].getMetadata()._metadata;
+          var episodes = [];
+          metadata.video.seasons.forEach(function (season) {
+            episodes = episodes.concat(season.episodes);
+          });
+          for (var i = 0; i + 1 < episodes.length; ++i) {
+            if (String(episodes[i].id) === String(metadata.video.currentEpisode)) {
+              next.nid = String(episodes[i + 1].id);
+              next.title = episodes[i + 1].title || '';
+              break;
+            }
+          }
+        } catch (err) {
+          // Not a series, or the player layout changed.
+        }
+        return next;
+      };
+
+      controller.next = function () {
+        var goNext = document.querySelector(nextEpisodeSelector);
+        if (goNext) goNext.click();
+      };
+    }
+  });
+})();
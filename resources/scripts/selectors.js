@@ -0,0 +1,64 @@
+// Controller driven by the provider's selectors, see
+// resources/providers/providers.json. `__qwfProvider` is defined right
+// before this script runs.
+//
+//   title: selectors whose text is joined to form the title, the page
+//          title if none is given
+//   nid:   "offsetParent" for the id of the video's offset parent, or a
+//          selector whose element id is used
+//   art:   selectors tried in order, an element's src attribute or its
+//          background image url is used
+(function () {
+  var provider = window.__qwfProvider || { name: 'default', selectors: {} };
+  var selectors = provider.selectors || {};
+  if (window.__qwf && window.__qwf.provider === provider.name) return;
+
+  function list(value) {
+    if (!value) return [];
+    return Array.isArray(value) ? value : [value];
+  }
+
+  function title() {
+    var parts = [];
+    list(selectors.title).forEach(function (selector) {
+      var element = document.querySelector(selector);
+      if (element && element.innerText) parts.push(element.innerText);
+    });
+    return parts.length ? parts.join(' ') : document.title || 'Playing Video';
+  }
+
+  function nid(vid) {
+    if (!selectors.nid) return '';
+    if (selectors.nid === 'offsetParent')
+      return vid && vid.offsetParent ? vid.offsetParent.id : '';
+    var element = document.querySelector(selectors.nid);
+    return element ? element.id : '';
+  }
+
+  function art() {
+    var selectorList = list(selectors.art);
+    for (var i = 0; i < selectorList.length; ++i) {
+      var element = document.querySelector(selectorList[i]);
+      if (!element) continue;
+      if (element.getAttribute('src')) return element.getAttribute('src');
+      var image = /url\(["']?([^"')]+)/.exec(
+          element.style.backgroundImage || element.getAttribute('style') || '');
+      if (image) return image[1];
+    }
+    return '';
+  }
+
+  window.__qwf = __qwfController({
+    provider: provider.name,
+
+    matches: function (vid) {
+      return !!vid.getAttribute('src');
+    },
+
+    metadata: function (vid, snapshot) {
+      snapshot.title = title();
+      snapshot.nid = nid(vid);
+      snapshot.arturl = art();
+    }
+  });
+})();
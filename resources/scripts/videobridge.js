@@ -0,0 +1,48 @@
+// Pushes <video> state changes to the VideoBridge object exposed over
+// QWebChannel, so that MPRIS does not have to poll the page for them.
+// Requires qwebchannel.js to be loaded in the same world first.
+(function () {
+  if (window.__qwfBridge) return;
+  window.__qwfBridge = true;
+
+  var bridge = null;
+  var pending = null;
+
+  new QWebChannel(qt.webChannelTransport, function (channel) {
+    bridge = channel.objects.videoBridge;
+    if (pending) {
+      bridge.videoEvent(pending[0], pending[1]);
+      pending = null;
+    }
+  });
+
+  // States as controller.js derives them for snapshots, ended first.
+  function stateOf(video) {
+    var state = 'playing';
+    if (video.ended) state = 'stopped';
+    else if (video.paused) state = 'paused';
+    return {
+      state: state,
+      position: video.currentTime,
+      duration: isFinite(video.duration) ? video.duration : -1,
+      volume: video.volume,
+      rate: video.playbackRate
+    };
+  }
+
+  function push(type, video) {
+    if (bridge) bridge.videoEvent(type, stateOf(video));
+    else pending = [type, stateOf(video)];
+  }
+
+  ['play', 'playing', 'pause', 'ended', 'emptied', 'seeked',
+   'volumechange', 'durationchange', 'ratechange'].forEach(function (type) {
+    // Media events do not bubble, so listen in the capture phase.
+    document.addEventListener(type, function (event) {
+      var video = event.target;
+      if (!(video instanceof HTMLVideoElement)) return;
+      if (!video.getAttribute('src')) return;
+      push(event.type, video);
+    }, true);
+  });
+})();
@@ -0,0 +1,173 @@
+#include <iterator>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "artcache.h"
+
+ArtCache::ArtCache(int maxEntries, int ttlDays, QObject *parent)
+    : QObject(parent), m_maxEntries(maxEntries), m_ttlDays(ttlDays) {
+  m_path =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      "/titles.json";
+
+  // Batch writes, titles tend to arrive in bursts while browsing.
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(5000);
+  connect(&m_saveTimer, SIGNAL(timeout()), this, SLOT(save()));
+}
+
+ArtCache::~ArtCache() {
+  if (m_saveTimer.isActive()) {
+    save();
+  }
+}
+
+std::list<ArtCache::Node> ArtCache::read() const {
+  std::list<Node> nodes;
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return nodes;
+  }
+
+  QJsonArray entries = QJsonDocument::fromJson(file.readAll()).array();
+  for (const auto &value : entries) {
+    QJsonObject object = value.toObject();
+    Node node;
+    node.nid = object["nid"].toString();
+    node.entry.artUrl = object["artUrl"].toString();
+    node.entry.title = object["title"].toString();
+    node.entry.fetchedAt = QDateTime::fromMSecsSinceEpoch(
+        static_cast<qint64>(object["fetchedAt"].toDouble()));
+
+    if (node.nid.isEmpty() || expired(node.entry)) {
+      continue;
+    }
+    // The file is stored most recently used first.
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+void ArtCache::load() {
+  for (auto &node : read()) {
+    if (m_index.contains(node.nid)) {
+      continue;
+    }
+    m_order.push_back(node);
+    m_index.insert(node.nid, std::prev(m_order.end()));
+  }
+  evict();
+
+  qDebug() << "Loaded" << m_order.size() << "cached titles from" << m_path;
+}
+
+void ArtCache::save() {
+  m_saveTimer.stop();
+
+  auto toJson = [](const Node &node) {
+    QJsonObject object;
+    object["nid"] = node.nid;
+    object["artUrl"] = node.entry.artUrl;
+    object["title"] = node.entry.title;
+    object["fetchedAt"] =
+        static_cast<double>(node.entry.fetchedAt.toMSecsSinceEpoch());
+    return object;
+  };
+
+  QJsonArray entries;
+  for (const auto &node : m_order) {
+    entries.append(toJson(node));
+  }
+  // After clear() memory only holds what came since, the file still has
+  // the rest. Those follow as less recently used, up to the size limit.
+  if (m_cleared) {
+    for (const auto &node : read()) {
+      if (entries.size() >= m_maxEntries) {
+        break;
+      }
+      if (!m_index.contains(node.nid)) {
+        entries.append(toJson(node));
+      }
+    }
+  }
+
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+  QSaveFile file(m_path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "Could not write title cache" << m_path;
+    return;
+  }
+  file.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+  file.commit();
+}
+
+bool ArtCache::lookup(const QString &nid, ArtCacheEntry *entry) {
+  auto it = m_index.find(nid);
+  if (it == m_index.end()) {
+    return false;
+  }
+
+  auto node = it.value();
+  if (expired(node->entry)) {
+    m_order.erase(node);
+    m_index.erase(it);
+    m_saveTimer.start();
+    return false;
+  }
+
+  // The file keeps the order, so recency survives a restart.
+  if (node != m_order.begin()) {
+    m_order.splice(m_order.begin(), m_order, node);
+    m_saveTimer.start();
+  }
+  *entry = node->entry;
+  return true;
+}
+
+void ArtCache::insert(const QString &nid, const QString &artUrl,
+                      const QString &title) {
+  auto it = m_index.find(nid);
+  if (it != m_index.end()) {
+    m_order.erase(it.value());
+    m_index.erase(it);
+  }
+
+  Node node;
+  node.nid = nid;
+  node.entry.artUrl = artUrl;
+  node.entry.title = title;
+  node.entry.fetchedAt = QDateTime::currentDateTimeUtc();
+  m_order.push_front(node);
+  m_index.insert(nid, m_order.begin());
+  evict();
+
+  m_saveTimer.start();
+}
+
+void ArtCache::clear() {
+  m_order.clear();
+  m_index.clear();
+  m_saveTimer.stop();
+  m_cleared = true;
+}
+
+int ArtCache::size() const { return m_index.size(); }
+
+bool ArtCache::expired(const ArtCacheEntry &entry) const {
+  return entry.fetchedAt.addDays(m_ttlDays) < QDateTime::currentDateTimeUtc();
+}
+
+void ArtCache::evict() {
+  while (static_cast<int>(m_order.size()) > m_maxEntries) {
+    m_index.remove(m_order.back().nid);
+    m_order.pop_back();
+  }
+}
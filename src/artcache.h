@@ -0,0 +1,65 @@
+#ifndef ARTCACHE_H
+#define ARTCACHE_H
+
+#include <list>
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+struct ArtCacheEntry {
+  QString artUrl;
+  QString title;
+  QDateTime fetchedAt;
+};
+
+// Bounded, persistent nid -> title info cache. The whole file is read once at
+// startup; entries older than the TTL are dropped and the least recently used
+// ones are evicted past the size limit.
+class ArtCache : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ArtCache(int maxEntries, int ttlDays, QObject *parent = nullptr);
+  ~ArtCache();
+
+  void load();
+
+  // Copies the entry for `nid` to `entry` and marks it as recently used.
+  bool lookup(const QString &nid, ArtCacheEntry *entry);
+  void insert(const QString &nid, const QString &artUrl, const QString &title);
+  // Drops the in-memory entries, the file on disk is kept. Later saves
+  // merge with it rather than replacing it.
+  void clear();
+  int size() const;
+
+public slots:
+  void save();
+
+private:
+  struct Node {
+    QString nid;
+    ArtCacheEntry entry;
+  };
+
+  // Unexpired entries of the file on disk, most recently used first.
+  std::list<Node> read() const;
+  bool expired(const ArtCacheEntry &entry) const;
+  void evict();
+
+  QString m_path;
+  int m_maxEntries;
+  int m_ttlDays;
+
+  // Most recently used first.
+  std::list<Node> m_order;
+  QHash<QString, std::list<Node>::iterator> m_index;
+  // Set once clear() has dropped entries that only the file still has.
+  bool m_cleared = false;
+
+  QTimer m_saveTimer;
+};
+
+#endif // ARTCACHE_H
@@ -7,7 +7,7 @@ Commandlineparser::Commandlineparser() {
   QCoreApplication::setApplicationName("qtwebflix");
   QCoreApplication::setApplicationVersion(QVariant(GIT_VERSION).toString());
   parser.setApplicationDescription(
-      "\nQtwebflix Help\n\n Shortcuts:\n CTRL + Q to quit\n CTRL + F11 for full screen\n CTRL + F5 to reload\n\n To Control playback rate:\n CTRL + W = speed up \n "
+      "\nQtwebflix Help\n\n Shortcuts:\n CTRL + Q to quit\n CTRL + F11 for full screen\n CTRL + F5 to reload\n CTRL + T for a new tab\n CTRL + F4 to close a tab\n\n To Control playback rate:\n CTRL + W = speed up \n "
       "CTRL + S = slow down \n CTRL + R = reset to defualt");
   parser.addHelpOption();
   parser.addVersionOption();
@@ -35,6 +35,23 @@ Commandlineparser::Commandlineparser() {
                                "main", "Do not use HD addon, you will be limited to 720p"));
   parser.addOption(nonHD);
 
+  QCommandLineOption capture(
+      QStringList() << "c"
+                    << "capture",
+      QCoreApplication::translate(
+          "main", "Record all network requests and write them as HAR to "
+                  "file on exit"),
+      QCoreApplication::translate("main", "file"));
+  parser.addOption(capture);
+
+  QCommandLineOption trace(
+      QStringList() << "t"
+                    << "trace",
+      QCoreApplication::translate(
+          "main", "Write startup phases as Chrome trace events to file on exit"),
+      QCoreApplication::translate("main", "file"));
+  parser.addOption(trace);
+
   QStringList webOptions = {"--register-pepper-plugins",
                             "--disable-seccomp-filter-sandbox",
                             "--disable-logging",
@@ -78,12 +95,22 @@ Commandlineparser::Commandlineparser() {
   } else {
     nonHDset_ = false;
   }
+
+  captureFile_ = parser.value(capture);
+  traceFile_ = parser.value(trace);
 }
 
 bool Commandlineparser::providerIsSet() const { return providerSet_; }
 
 bool Commandlineparser::userAgentisSet() const { return userAgentset_; }
 bool Commandlineparser::nonHDisSet() const { return nonHDset_; }
+bool Commandlineparser::captureIsSet() const { return !captureFile_.isEmpty(); }
+
+QString Commandlineparser::getCaptureFile() const { return captureFile_; }
+
+bool Commandlineparser::traceIsSet() const { return !traceFile_.isEmpty(); }
+
+QString Commandlineparser::getTraceFile() const { return traceFile_; }
 
 QString Commandlineparser::getProvider() const { return provider_; }
 
@@ -12,6 +12,10 @@ public:
   bool providerIsSet() const;
   bool userAgentisSet() const;
   bool nonHDisSet() const;
+  bool captureIsSet() const;
+  QString getCaptureFile() const;
+  bool traceIsSet() const;
+  QString getTraceFile() const;
 
 private:
   QString provider_;
@@ -19,6 +23,8 @@ private:
   bool providerSet_;
   bool userAgentset_;
   bool nonHDset_;
+  QString captureFile_;
+  QString traceFile_;
 };
 
 #endif // COMMANDLINEPARSER_H
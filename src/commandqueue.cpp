@@ -0,0 +1,88 @@
+#include "commandqueue.h"
+
+namespace {
+
+// Long enough to catch key repeat (usually 25-50 ms) and slider drags,
+// short enough not to be noticed.
+const int defaultWindow = 100;
+
+} // namespace
+
+CommandQueue::CommandQueue(QObject *parent) : QObject(parent) {
+  m_timer.setInterval(defaultWindow);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+void CommandQueue::setWindow(int window) { m_timer.setInterval(window); }
+
+void CommandQueue::seek(qlonglong offset) {
+  if (m_hasPosition) {
+    m_position += offset;
+  } else {
+    m_seek += offset;
+    m_hasSeek = true;
+  }
+  enqueued();
+}
+
+void CommandQueue::setPosition(qlonglong position) {
+  m_hasSeek = false;
+  m_seek = 0;
+  m_position = position;
+  m_hasPosition = true;
+  enqueued();
+}
+
+void CommandQueue::setVolume(double volume) {
+  m_volume = volume;
+  m_hasVolume = true;
+  enqueued();
+}
+
+void CommandQueue::clear() {
+  m_hasSeek = m_hasPosition = m_hasVolume = false;
+  m_seek = 0;
+  m_timer.stop();
+}
+
+qint64 CommandQueue::received() const { return m_received; }
+
+qint64 CommandQueue::sent() const { return m_sent; }
+
+void CommandQueue::enqueued() {
+  ++m_received;
+  // Quiet until now, no need to wait for more.
+  if (!m_timer.isActive()) {
+    flush();
+    m_timer.start();
+  }
+}
+
+void CommandQueue::flush() {
+  if (!m_hasSeek && !m_hasPosition && !m_hasVolume) {
+    // Nothing came during the window, the next request goes out at once.
+    m_timer.stop();
+    return;
+  }
+
+  if (m_hasPosition) {
+    m_hasPosition = false;
+    ++m_sent;
+    emit positionReady(m_position);
+  }
+  if (m_hasSeek) {
+    m_hasSeek = false;
+    qlonglong offset = m_seek;
+    m_seek = 0;
+    // Seeks that cancelled each other out.
+    if (offset != 0) {
+      ++m_sent;
+      emit seekReady(offset);
+    }
+  }
+  if (m_hasVolume) {
+    m_hasVolume = false;
+    ++m_sent;
+    emit volumeReady(m_volume);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <QObject>
+#include <QTimer>
+
+// Merges the seek, position and volume requests MprisInterface receives
+// before they reach the page. Holding a seek key or dragging a volume slider
+// produces a request every few milliseconds, and each one would otherwise be
+// a runJavaScript and, for Netflix, a seek of the player.
+//
+// The first request after a quiet period goes out at once. Requests arriving
+// within the window after it are merged and go out together when the window
+// ends: relative seeks add up, and of absolute positions and volumes only
+// the last one is kept. A position supersedes the seeks before it, seeks
+// after a position move that position instead.
+class CommandQueue : public QObject {
+  Q_OBJECT
+
+public:
+  explicit CommandQueue(QObject *parent = nullptr);
+
+  // Time in ms during which requests are merged.
+  void setWindow(int window);
+
+  // Offsets and positions are in microseconds.
+  void seek(qlonglong offset);
+  void setPosition(qlonglong position);
+  void setVolume(double volume);
+  // Drops pending requests, e.g. when they were meant for another page.
+  void clear();
+
+  // Requests received and commands emitted since construction.
+  qint64 received() const;
+  qint64 sent() const;
+
+signals:
+  void seekReady(qlonglong offset);
+  void positionReady(qlonglong position);
+  void volumeReady(double volume);
+
+private slots:
+  void flush();
+
+private:
+  void enqueued();
+
+  QTimer m_timer;
+
+  bool m_hasSeek = false;
+  qlonglong m_seek = 0;
+  bool m_hasPosition = false;
+  qlonglong m_position = 0;
+  bool m_hasVolume = false;
+  double m_volume = 0;
+
+  qint64 m_received = 0;
+  qint64 m_sent = 0;
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,47 @@
+#ifndef CONTROLLERSCRIPTS_H
+#define CONTROLLERSCRIPTS_H
+
+#include <QString>
+
+// The calls MprisInterface makes into the page's `__qwf` controller, see
+// resources/scripts/controller.js. They are the same for every provider,
+// what differs is the controller script installed in the page.
+enum class ControllerCall {
+  Play,
+  Pause,
+  Toggle,
+  Next,
+  Snapshot,
+  NextEpisode,
+  Seek,
+  SetPosition,
+  SetVolume,
+};
+
+// Source of each call, as QStringLiteral data laid out at compile time. A
+// call taking a number is a constant prefix, the number is passed to
+// MprisInterface::callController() and appended to it there, so that no
+// script is assembled with QString::arg() on every call.
+template <ControllerCall call> struct ControllerScript;
+
+#define CONTROLLER_SCRIPT(call, script, argumentDecimals)                      \
+  template <> struct ControllerScript<ControllerCall::call> {                  \
+    static QString source() { return QStringLiteral(script); }                 \
+    /* -1 for calls without argument. */                                       \
+    static constexpr int decimals = argumentDecimals;                          \
+  };
+
+CONTROLLER_SCRIPT(Play, "__qwf.play()", -1)
+CONTROLLER_SCRIPT(Pause, "__qwf.pause()", -1)
+CONTROLLER_SCRIPT(Toggle, "__qwf.toggle()", -1)
+CONTROLLER_SCRIPT(Next, "__qwf.next()", -1)
+CONTROLLER_SCRIPT(Snapshot, "window.__qwf ? __qwf.snapshot() : null", -1)
+CONTROLLER_SCRIPT(NextEpisode, "window.__qwf ? __qwf.nextEpisode() : null", -1)
+// In seconds.
+CONTROLLER_SCRIPT(Seek, "__qwf.seek(", 3)
+CONTROLLER_SCRIPT(SetPosition, "__qwf.setPosition(", 3)
+CONTROLLER_SCRIPT(SetVolume, "__qwf.setVolume(", 6)
+
+#undef CONTROLLER_SCRIPT
+
+#endif // CONTROLLERSCRIPTS_H
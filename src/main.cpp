@@ -6,21 +6,38 @@
 #include <QWebEngineUrlRequestInterceptor>
 #include <QWebEngineView>
 
+#include "commandlineparser.h"
 #include "mainwindow.h"
+#include "scriptcache.h"
+#include "tracer.h"
 
 //#include <KAboutData>
 
 int main(int argc, char *argv[]) {
+  // Starts the trace clock.
+  Tracer &tracer = Tracer::instance();
 
+  ScriptCache::registerScheme();
   QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
   QApplication app(argc, argv);
    QApplication::setWindowIcon(QIcon(":/resources/qtwebflix.svg"));
 
+  // create parser object and get arguemts
+  Commandlineparser parser;
+  if (parser.traceIsSet()) {
+    tracer.enable(parser.getTraceFile());
+    tracer.complete("QApplication", 0, tracer.now());
+  }
 
   MainWindow w;
 
-  w.show();
-  w.parseCommand();
+  {
+    TraceScope trace("show");
+    w.show();
+  }
+  w.parseCommand(parser);
 
-  return app.exec();
+  int result = app.exec();
+  tracer.save();
+  return result;
 }
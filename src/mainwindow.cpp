@@ -1,7 +1,12 @@
 #include <QContextMenuEvent>
 #include <QDebug>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QSettings>
 #include <QStandardPaths>
+#include <QTabWidget>
+#include <QTimer>
 #include <QWebEngineFullScreenRequest>
 #include <QWebEngineProfile>
 #include <QWebEngineSettings>
@@ -9,90 +14,143 @@
 #include <QWebEngineView>
 #include <QWidget>
 
-#include "amazonmprisinterface.h"
 #include "commandlineparser.h"
 #include "defaultmprisinterface.h"
 #include "mainwindow.h"
 #include "mprisinterface.h"
 #include "netflixmprisinterface.h"
+#include "tracer.h"
 #include "ui_mainwindow.h"
 #include "urlrequestinterceptor.h"
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow),
-      mprisType(typeid(DefaultMprisInterface)),
-      mpris(new DefaultMprisInterface) {
-  QWebEngineSettings::globalSettings()->setAttribute(
-      QWebEngineSettings::PluginsEnabled, true);
-  stateSettings = new QSettings("Qtwebflix", "Save State", this);
-  appSettings = new QSettings("Qtwebflix", "qtwebflix", this);
-  QWebEngineProfile::defaultProfile()->setPersistentCookiesPolicy(
-      QWebEngineProfile::ForcePersistentCookies);
-
-  QFile file;
-  file.setFileName(":/jquery.min.js");
-  file.open(QIODevice::ReadOnly);
-  jQuery = file.readAll();
-  jQuery.append("\nvar qt = { 'jQuery': jQuery.noConflict(true) };");
-  file.close();
-
-  ui->setupUi(this);
-  this->setWindowTitle("QtWebFlix");
-  readSettings();
-  webview = new QWebEngineView;
-  ui->horizontalLayout->addWidget(webview);
-
-  if (appSettings->value("site").toString() == "") {
-    webview->setUrl(QUrl(QStringLiteral("https://netflix.com")));
-  } else {
-    webview->setUrl(QUrl(stateSettings->value("site").toString()));
+    : QMainWindow(parent), ui(new Ui::MainWindow) {
+  m_startup.start();
+  TraceScope traceConstructor("MainWindow");
+
+  {
+    TraceScope trace("settings");
+    QWebEngineSettings::globalSettings()->setAttribute(
+        QWebEngineSettings::PluginsEnabled, true);
+    stateSettings = new QSettings("Qtwebflix", "Save State", this);
+    appSettings = new QSettings("Qtwebflix", "qtwebflix", this);
+    QWebEngineProfile::defaultProfile()->setPersistentCookiesPolicy(
+        QWebEngineProfile::ForcePersistentCookies);
+
+    // Title art and names seen in earlier sessions.
+    m_artCache = new ArtCache(
+        appSettings->value("cache/titleEntries", 500).toInt(),
+        appSettings->value("cache/titleTtlDays", 30).toInt(), this);
+    m_artCache->load();
+
+    // Providers defined next to the settings add to or replace the bundled
+    // ones.
+    m_providers.load(QFileInfo(appSettings->fileName()).absolutePath() +
+                     "/providers.json");
   }
-  webview->settings()->setAttribute(
-      QWebEngineSettings::FullScreenSupportEnabled, true);
-// Check for QT if equal or greater than 5.10 hide scrollbars
-#if HAS_SCROLLBAR
-  webview->settings()->setAttribute(QWebEngineSettings::ShowScrollBars, false);
-#endif
 
-  // connect handler for fullscreen press on video
-  connect(webview->page(), &QWebEnginePage::fullScreenRequested, this,
-          &MainWindow::fullScreenRequested);
+  // Bundled scripts are only read once a page needs them.
+  m_scriptAssets = new ScriptAssets(this);
 
-  // default key shortcuts
-  addShortcut("fullscreen-toggle", "F11");
-  addShortcut("quit", "Ctrl+Q");
-  addShortcut("speed-up", "Ctrl+W");
-  addShortcut("speed-down", "Ctrl+S");
-  addShortcut("speed-default", "Ctrl+R");
-  addShortcut("reload", "Ctrl+F5");
-
-  appSettings->beginGroup("keybinds");
-  for (auto action : appSettings->allKeys()) {
-    auto keySequence = appSettings->value(action).toStringList().join(',');
-    for (auto key :
-         keySequence.split(QRegExp("\\s+"), QString::SkipEmptyParts)) {
-      addShortcut(action, key);
+  {
+    TraceScope trace("setupUi");
+    ui->setupUi(this);
+    this->setWindowTitle("QtWebFlix");
+  }
+  {
+    TraceScope trace("readSettings");
+    readSettings();
+  }
+  {
+    TraceScope trace("webview");
+    // All tabs share the default profile and with it one browser process.
+    m_tabs = new QTabWidget;
+    m_tabs->setDocumentMode(true);
+    m_tabs->setTabsClosable(true);
+    m_tabs->setTabBarAutoHide(true);
+    ui->horizontalLayout->addWidget(m_tabs);
+    connect(m_tabs, &QTabWidget::currentChanged, this,
+            &MainWindow::currentTabChanged);
+    connect(m_tabs, &QTabWidget::tabCloseRequested, this,
+            &MainWindow::closeTab);
+
+    if (appSettings->value("site").toString() == "") {
+      m_startUrl = QUrl(QStringLiteral("https://netflix.com"));
+    } else {
+      m_startUrl = QUrl(stateSettings->value("site").toString());
     }
+    // The first page only starts loading once the event loop runs, so that
+    // parseCommand() can install request capture and interception before
+    // its first request goes out. A page loaded by then is left alone.
+    addTab(QUrl());
+    QTimer::singleShot(0, this, [this]() {
+      QWebEngineView *view = m_webTabs.first()->view();
+      if (view->url().isEmpty()) {
+        view->setUrl(m_startUrl);
+      }
+    });
   }
-  appSettings->endGroup();
-  registerShortcutActions();
 
-  // Connect finished loading boolean
-  connect(webview, &QWebEngineView::loadFinished, this,
-          &MainWindow::finishLoading);
+  {
+    TraceScope trace("shortcuts");
+    // default key shortcuts
+    addShortcut("fullscreen-toggle", "F11");
+    addShortcut("quit", "Ctrl+Q");
+    addShortcut("speed-up", "Ctrl+W");
+    addShortcut("speed-down", "Ctrl+S");
+    addShortcut("speed-default", "Ctrl+R");
+    addShortcut("reload", "Ctrl+F5");
+    addShortcut("new-tab", "Ctrl+T");
+    addShortcut("close-tab", "Ctrl+F4");
+    addShortcut("next-tab", "Ctrl+PgDown");
+    addShortcut("prev-tab", "Ctrl+PgUp");
+
+    appSettings->beginGroup("keybinds");
+    for (auto action : appSettings->allKeys()) {
+      auto keySequence = appSettings->value(action).toStringList().join(',');
+      for (auto key :
+           keySequence.split(QRegExp("\\s+"), QString::SkipEmptyParts)) {
+        addShortcut(action, key);
+      }
+    }
+    appSettings->endGroup();
+    registerShortcutActions();
+  }
+
+  // Startup milestones, only the first of each is traced.
+  installEventFilter(this);
 
   // Window size settings
   QSettings settings;
   restoreState(settings.value("mainWindowState").toByteArray());
 
-  webview->setContextMenuPolicy(Qt::CustomContextMenu);
-  connect(webview, SIGNAL(customContextMenuRequested(const QPoint &)), this,
-          SLOT(ShowContextMenu(const QPoint &)));
+  {
+    TraceScope trace("mpris");
+    setMprisInterface(m_providers.defaultProvider());
+  }
 
-  mpris->setup(this);
+  // Thresholds in MiB for the whole process tree, see MemoryMonitor. The
+  // first step only empties the disk cache, so it is off unless asked for.
+  m_memoryMonitor = new MemoryMonitor(
+      this, appSettings->value("memory/intervalSeconds", 30).toInt() * 1000,
+      {appSettings->value("memory/clearDiskCacheMiB", 0).toInt(),
+       appSettings->value("memory/discardTabsMiB", 1536).toInt(),
+       appSettings->value("memory/dropArtCacheMiB", 2048).toInt(),
+       appSettings->value("memory/reloadMiB", 3072).toInt()},
+      this);
+  m_memoryMonitor->start();
 }
 
 MainWindow::~MainWindow() {
+  if (m_interceptor) {
+    m_interceptor->logStatistics();
+    // The profile outlives the window, the interceptor and the capture it
+    // records into do not.
+    webView()->page()->profile()->setRequestInterceptor(nullptr);
+  }
+  if (m_capture) {
+    m_capture->save();
+  }
   delete ui;
   // qDeleteAll(m_shortcuts);
 }
@@ -105,7 +163,112 @@ void MainWindow::toggleFullScreen() {
   this->setFullScreen(!this->isFullScreen());
 }
 
-QWebEngineView *MainWindow::webView() const { return webview; }
+QWebEngineView *MainWindow::webView() const { return currentTab()->view(); }
+
+VideoBridge *MainWindow::videoBridge() const {
+  return currentTab()->bridge();
+}
+
+WebTab *MainWindow::currentTab() const {
+  QWidget *view = m_tabs->currentWidget();
+  for (auto tab : m_webTabs) {
+    if (tab->view() == view) {
+      return tab;
+    }
+  }
+  return m_webTabs.first();
+}
+
+QVector<WebTab *> MainWindow::tabs() const { return m_webTabs; }
+
+WebTab *MainWindow::addTab(const QUrl &url) {
+  auto tab = new WebTab(m_scriptAssets,
+                        appSettings->value("tabs/freezeSeconds", 60).toInt(),
+                        appSettings->value("tabs/discardSeconds", 600).toInt(),
+                        this);
+  m_webTabs.append(tab);
+  QWebEngineView *view = tab->view();
+
+  // connect handler for fullscreen press on video
+  connect(view->page(), &QWebEnginePage::fullScreenRequested, this,
+          &MainWindow::fullScreenRequested);
+
+  // Connect finished loading boolean
+  connect(view, &QWebEngineView::loadFinished, this,
+          &MainWindow::finishLoading);
+  connect(view, &QWebEngineView::titleChanged, this,
+          [this, view](const QString &title) {
+            m_tabs->setTabText(m_tabs->indexOf(view), title);
+          });
+
+  view->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(view, SIGNAL(customContextMenuRequested(const QPoint &)), this,
+          SLOT(ShowContextMenu(const QPoint &)));
+
+  connect(tab->bridge(), &VideoBridge::videoStateChanged, this,
+          [](const QString &type) {
+            if (type == "playing") {
+              Tracer::instance().instant("firstPlaying");
+            }
+          });
+  if (m_capture) {
+    connectCapture(tab);
+  }
+
+  if (!url.isEmpty()) {
+    view->setUrl(url);
+  }
+  m_tabs->setCurrentIndex(m_tabs->addTab(view, url.host()));
+  return tab;
+}
+
+void MainWindow::closeTab(int index) {
+  if (m_webTabs.size() <= 1) {
+    return;
+  }
+
+  QWidget *view = m_tabs->widget(index);
+  for (int i = 0; i < m_webTabs.size(); ++i) {
+    if (m_webTabs[i]->view() == view) {
+      WebTab *tab = m_webTabs.takeAt(i);
+      m_tabs->removeTab(index);
+      delete tab;
+      break;
+    }
+  }
+}
+
+void MainWindow::currentTabChanged(int index) {
+  if (index < 0 || m_webTabs.isEmpty()) {
+    return;
+  }
+
+  WebTab *current = currentTab();
+  for (auto tab : m_webTabs) {
+    tab->setForeground(tab == current);
+  }
+
+  // MPRIS follows the foreground tab, even to another page of the same
+  // provider.
+  if (mpris) {
+    exchangeMprisInterfaceIfNeeded(true);
+  }
+}
+
+void MainWindow::connectCapture(WebTab *tab) {
+  connect(tab->view(), &QWebEngineView::loadStarted, m_capture,
+          &NetworkCapture::loadStarted);
+  connect(tab->view(), &QWebEngineView::loadFinished, m_capture,
+          &NetworkCapture::loadFinished);
+  connect(tab->bridge(), &VideoBridge::videoStateChanged, m_capture,
+          &NetworkCapture::videoStateChanged);
+}
+
+ArtCache *MainWindow::artCache() const { return m_artCache; }
+
+ScriptAssets *MainWindow::scriptAssets() const { return m_scriptAssets; }
+
+MprisInterface *MainWindow::mprisInterface() const { return mpris; }
 
 // Slot handler for Ctrl + Q
 void MainWindow::quit() {
@@ -113,7 +276,22 @@ void MainWindow::quit() {
   QApplication::quit();
 }
 
-void MainWindow::finishLoading(bool) { exchangeMprisInterfaceIfNeeded(); }
+void MainWindow::finishLoading(bool) {
+  Tracer::instance().instant("loadFinished");
+
+  // Background tabs keep loading without taking over MPRIS.
+  if (sender() == webView()) {
+    exchangeMprisInterfaceIfNeeded();
+  }
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event) {
+  if (watched == this && event->type() == QEvent::Paint) {
+    Tracer::instance().instant("firstPaint");
+    removeEventFilter(this);
+  }
+  return QMainWindow::eventFilter(watched, event);
+}
 
 void MainWindow::addShortcut(const QString &actionName, const QString &key) {
   qDebug() << "binding " << key << "\t-> " << actionName;
@@ -131,46 +309,57 @@ void MainWindow::registerShortcutActions() {
   m_actions["fullscreen-toggle"] =
       std::function<void()>([&]() { this->toggleFullScreen(); });
   m_actions["reload"] = std::function<void()>([&]() { this->reloadPage(); });
+  m_actions["new-tab"] = std::function<void()>(
+      [&]() { addTab(QUrl(QStringLiteral("https://netflix.com"))); });
+  m_actions["close-tab"] = std::function<void()>(
+      [&]() { closeTab(m_tabs->currentIndex()); });
+  m_actions["next-tab"] = std::function<void()>([&]() {
+    m_tabs->setCurrentIndex((m_tabs->currentIndex() + 1) % m_tabs->count());
+  });
+  m_actions["prev-tab"] = std::function<void()>([&]() {
+    m_tabs->setCurrentIndex((m_tabs->currentIndex() + m_tabs->count() - 1) %
+                            m_tabs->count());
+  });
   m_actions["quit"] = std::function<void()>([&]() { this->quit(); });
   m_actions["speed-up"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.rateRequested(2)); });
   });
   m_actions["speed-down"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.rateRequested(0.5)); });
   });
   m_actions["speed-default"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.rateRequested(1)); });
   });
   m_actions["play"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.playRequested()); });
   });
   m_actions["pause"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.pauseRequested()); });
   });
   m_actions["play-pause"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.playPauseRequested()); });
   });
   m_actions["prev-episode"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.previousRequested()); });
   });
   m_actions["next-episode"] = std::function<void()>([&]() {
-    mpris->workWithPlayer(
+    m_mprisHost.workWithPlayer(
         [](MprisPlayer &player) { emit(player.nextRequested()); });
   });
   m_actions["seek-next"] = std::function<void()>([&]() {
-    mpris->workWithPlayer([](MprisPlayer &player) {
+    m_mprisHost.workWithPlayer([](MprisPlayer &player) {
       emit(player.seekRequested(10 * 1000 * 1000));
     });
   });
   m_actions["seek-prev"] = std::function<void()>([&]() {
-    mpris->workWithPlayer([](MprisPlayer &player) {
+    m_mprisHost.workWithPlayer([](MprisPlayer &player) {
       emit(player.seekRequested(-10 * 1000 * 1000));
     });
   });
@@ -186,30 +375,61 @@ void MainWindow::registerShortcutActions() {
       });
 }
 
-void MainWindow::exchangeMprisInterfaceIfNeeded() {
-  QString hostname = webview->url().host();
-  if (hostname.endsWith("netflix.com")) {
-    setMprisInterface<NetflixMprisInterface>();
-  } else if (hostname.endsWith("amazon.com")) {
-    // use javascript to change useragent to watch HD Amazon Prime Videos as
-    // using QT crashes the program.
-    QString code =
-        "window.navigator.__defineGetter__('userAgent', function () {"
-        "return 'Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
-        "(KHTML, like Gecko) Chrome/68.0.3440.84 Safari/537.36 "
-        "OPR/55.0.2994.34 (Edition beta)';"
-        "});";
+void MainWindow::exchangeMprisInterfaceIfNeeded(bool reattach) {
+  const Provider &provider = m_providers.lookup(webView()->url().host());
 
+  if (!provider.userAgent.isEmpty()) {
+    // Overriding the useragent through javascript, e.g. to watch HD Amazon
+    // Prime Videos as using QT crashes the program.
+    QString code =
+        QStringLiteral("window.navigator.__defineGetter__('userAgent', "
+                       "function () { return %1[0]; });")
+            .arg(QString::fromUtf8(QJsonDocument(QJsonArray{provider.userAgent})
+                                       .toJson(QJsonDocument::Compact)));
     webView()->page()->runJavaScript(code);
+  }
 
-    setMprisInterface<AmazonMprisInterface>();
-  } else {
-    setMprisInterface<DefaultMprisInterface>();
+  setMprisInterface(provider, reattach);
+}
+
+bool MainWindow::setMprisInterface(const Provider &provider, bool reattach) {
+  if (!reattach && mpris && mpris->provider().name == provider.name) {
+    return false;
+  }
+
+  qDebug() << "Transitioning to MPRIS interface for" << provider.name;
+  if (mpris) {
+    mpris->detach();
+  }
+
+  // Backends are created once per provider and reused, the player and its
+  // D-Bus registration stay the same throughout.
+  std::unique_ptr<MprisInterface> &backend = m_backends[provider.name];
+  if (!backend) {
+    if (provider.interface == "netflix") {
+      backend.reset(new NetflixMprisInterface(provider));
+    } else {
+      backend.reset(new DefaultMprisInterface(provider));
+    }
+    backend->setup(this, &m_mprisHost);
+  }
+  mpris = backend.get();
+  mpris->attach();
+
+  return true;
+}
+
+void MainWindow::reloadAndResume() {
+  qlonglong position = mpris->position();
+  if (position > 0) {
+    mpris->resumeAt(position);
   }
+  qDebug() << "Reloading, resuming at" << position / 1000000 << "s";
+  webView()->reload();
 }
 
 void MainWindow::reloadPage() {
-  webview->triggerPageAction(QWebEnginePage::ReloadAndBypassCache);
+  webView()->triggerPageAction(QWebEnginePage::ReloadAndBypassCache);
 }
 
 void MainWindow::setFullScreen(bool fullscreen) {
@@ -230,7 +450,7 @@ void MainWindow::writeSettings() {
   // Write the values to disk in categories.
   stateSettings->setValue("state/mainWindowState", saveState());
   stateSettings->setValue("geometry/mainWindowGeometry", saveGeometry());
-  QString site = webview->url().toString();
+  QString site = webView()->url().toString();
   stateSettings->setValue("site", site);
   qDebug() << " write settings:" << site;
 }
@@ -248,18 +468,24 @@ void MainWindow::restore() {
 }
 
 void MainWindow::createContextMenu(const QStringList &keys) {
+  QMenu *newTabMenu = new QMenu(tr("Open in new tab"), &contextMenu);
   appSettings->beginGroup("providers");
   for (const auto &i : keys) {
     if (!i.startsWith("#")) {
       auto url = appSettings->value(i).toUrl();
       contextMenu.addAction(i, [this, url]() {
         qDebug() << "Switching to : " << url;
-        webview->setUrl(QUrl(url));
+        webView()->setUrl(QUrl(url));
       });
       contextMenu.addSeparator();
+      newTabMenu->addAction(i, [this, url]() {
+        qDebug() << "Opening in new tab : " << url;
+        addTab(url);
+      });
     }
   }
   appSettings->endGroup();
+  contextMenu.addMenu(newTabMenu);
 }
 
 void MainWindow::readSettings() {
@@ -294,33 +520,69 @@ void MainWindow::fullScreenRequested(QWebEngineFullScreenRequest request) {
 
 void MainWindow::ShowContextMenu(const QPoint &pos) // this is a slot
 {
-  QPoint globalPos = webview->mapToGlobal(pos);
+  QPoint globalPos = webView()->mapToGlobal(pos);
   contextMenu.exec(globalPos);
 }
 
-void MainWindow::parseCommand() {
-  // create parser object and get arguemts
-  Commandlineparser parser;
+void MainWindow::parseCommand(const Commandlineparser &parser) {
+  TraceScope trace("parseCommand");
 
   // check if argument is used and set provider
   if (parser.providerIsSet()) {
     if (parser.getProvider() == "") {
       qDebug() << "site is invalid reditecting to netflix.com";
-      webview->setUrl(QUrl(QStringLiteral("https://netflix.com")));
+      m_startUrl = QUrl(QStringLiteral("https://netflix.com"));
     } else if (parser.getProvider() != "") {
       qDebug() << "site is set to" << parser.getProvider();
-      webview->setUrl(QUrl::fromUserInput(parser.getProvider()));
+      m_startUrl = QUrl::fromUserInput(parser.getProvider());
     }
   }
 
   // check if argument is used and set useragent
   if (parser.userAgentisSet()) {
     qDebug() << "Changing useragent to :" << parser.getUserAgent();
-    this->webview->page()->profile()->setHttpUserAgent(parser.getUserAgent());
+    this->webView()->page()->profile()->setHttpUserAgent(parser.getUserAgent());
   }
+
+  UrlRuleSet rules;
   if (!parser.nonHDisSet()) {
-    this->m_interceptor = new UrlRequestInterceptor;
-    this->webview->page()->profile()->setRequestInterceptor(
+    if (!rules.load(*appSettings)) {
+      rules = UrlRuleSet::defaults();
+    }
+
+    // Serve redirect targets from the local cache rather than the CDN.
+    m_scriptCache = new ScriptCache(
+        appSettings->value("cache/scriptRefreshHours", 24).toInt(), this);
+    m_scriptCache->load();
+    this->webView()->page()->profile()->installUrlSchemeHandler(
+        ScriptCache::scheme, m_scriptCache);
+    for (int i = 0; i < rules.size(); ++i) {
+      const UrlRule &rule = rules.rule(i);
+      if (rule.action == UrlRule::Redirect) {
+        rules.setTarget(i, m_scriptCache->add(rule.name, rule.target));
+      }
+    }
+  }
+
+  // Tracking and telemetry requests listed next to the configuration are
+  // blocked before they leave the browser.
+  QString blocklist =
+      QFileInfo(appSettings->fileName()).absolutePath() + "/Blocklist.txt";
+  rules.loadFilterList(blocklist);
+
+  if (parser.captureIsSet()) {
+    m_capture = new NetworkCapture(parser.getCaptureFile(), m_startup, this);
+    m_capture->recordEvent("windowCreated");
+    for (auto tab : m_webTabs) {
+      connectCapture(tab);
+    }
+  }
+
+  if (rules.size() > 0 || m_capture) {
+    qDebug() << "Loaded" << rules.size() << "interceptor rules";
+    this->m_interceptor = new UrlRequestInterceptor(rules, this);
+    this->m_interceptor->setCapture(m_capture);
+    this->webView()->page()->profile()->setRequestInterceptor(
         this->m_interceptor);
   }
 }
@@ -2,12 +2,13 @@
 #define MAINWINDOW_H
 
 #include <functional>
+#include <map>
 #include <memory>
-#include <typeindex>
 
 #include <QAction>
 #include <QByteArray>
 #include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QMainWindow>
 #include <QMap>
 #include <QMenu>
@@ -16,11 +17,24 @@
 #include <QSet>
 #include <QSettings>
 #include <QShortcut>
+#include <QTabWidget>
+#include <QUrl>
+#include <QVector>
 #include <QWebEngineFullScreenRequest>
 #include <QWebEngineView>
 
+#include "artcache.h"
+#include "memorymonitor.h"
 #include "mprisinterface.h"
+#include "networkcapture.h"
+#include "providerregistry.h"
+#include "scriptassets.h"
+#include "scriptcache.h"
 #include "urlrequestinterceptor.h"
+#include "videobridge.h"
+#include "webtab.h"
+
+class Commandlineparser;
 
 namespace Ui {
 class MainWindow;
@@ -31,10 +45,21 @@ class MainWindow : public QMainWindow {
 
 public:
   explicit MainWindow(QWidget *parent = nullptr);
-  void parseCommand();
+  void parseCommand(const Commandlineparser &parser);
   ~MainWindow();
   void setFullScreen(bool fullscreen);
+  // The view and video bridge of the foreground tab.
   QWebEngineView *webView() const;
+  VideoBridge *videoBridge() const;
+  WebTab *currentTab() const;
+  QVector<WebTab *> tabs() const;
+  WebTab *addTab(const QUrl &url);
+  // Reloads the foreground page and seeks back to where playback was.
+  void reloadAndResume();
+  ArtCache *artCache() const;
+  ScriptAssets *scriptAssets() const;
+  // The backend driving the MPRIS player, null if none is attached.
+  MprisInterface *mprisInterface() const;
 
 private slots:
   // slots for handlers of hotkeys
@@ -43,29 +68,40 @@ private slots:
   void quit();
   void reloadPage();
   void ShowContextMenu(const QPoint &pos);
+  void closeTab(int index);
+  void currentTabChanged(int index);
 
 protected:
   // save window geometry
   void closeEvent(QCloseEvent *);
+  bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
   Ui::MainWindow *ui;
-  QWebEngineView *webview;
-  QString jQuery;
+  QTabWidget *m_tabs;
+  QVector<WebTab *> m_webTabs;
+  ArtCache *m_artCache;
+  ScriptAssets *m_scriptAssets;
 
   QSettings *stateSettings;
   QSettings *appSettings;
 
   QMenu contextMenu;
 
-  std::type_index mprisType;
-  std::unique_ptr<MprisInterface> mpris;
+  // Declared before the backends, which publish to it until destroyed.
+  MprisPlayerHost m_mprisHost;
+  // Backends by provider name, `mpris` is the attached one.
+  std::map<QString, std::unique_ptr<MprisInterface>> m_backends;
+  MprisInterface *mpris = nullptr;
 
   void fullScreenRequested(QWebEngineFullScreenRequest request);
   void writeSettings();
   void readSettings();
   void restore();
-  void exchangeMprisInterfaceIfNeeded();
+  // Switches MPRIS to the foreground tab's provider. `reattach` does so even
+  // if the provider stays the same, e.g. when another tab came to the front.
+  void exchangeMprisInterfaceIfNeeded(bool reattach = false);
+  void connectCapture(WebTab *tab);
   void addShortcut(const QString &, const QString &);
   void registerShortcutActions();
   void createContextMenu(const QStringList &keys);
@@ -74,24 +110,18 @@ private:
   QMap<QString, std::function<void()>> m_actions;
   std::map<QString, QSet<const QShortcut *>> m_shortcuts;
 
-  UrlRequestInterceptor *m_interceptor;
-
-  template <typename Interface> bool setMprisInterface() {
-    std::type_index newType(typeid(Interface));
-    if (mprisType == newType) {
-      return false;
-    }
-
-    qDebug() << "Transitioning to new MPRIS interface: "
-             << typeid(Interface).name();
-    mprisType = newType;
-    mpris.reset();
+  UrlRequestInterceptor *m_interceptor = nullptr;
+  ScriptCache *m_scriptCache = nullptr;
+  NetworkCapture *m_capture = nullptr;
+  // Loaded in the first tab once the event loop runs, see the constructor.
+  QUrl m_startUrl;
+  MemoryMonitor *m_memoryMonitor;
+  // Started first thing in the constructor.
+  QElapsedTimer m_startup;
 
-    mpris = std::make_unique<Interface>();
-    mpris->setup(this);
+  ProviderRegistry m_providers;
 
-    return true;
-  }
+  bool setMprisInterface(const Provider &provider, bool reattach = false);
 };
 
 #endif // MAINWINDOW_H
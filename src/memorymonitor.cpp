@@ -0,0 +1,211 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QWebEngineProfile>
+#include <QWebEngineView>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#include "artcache.h"
+#include "mainwindow.h"
+#include "memorymonitor.h"
+#include "webtab.h"
+
+namespace {
+
+// Time for a step to take effect before its result is logged.
+const int reportDelay = 5000;
+
+#ifdef Q_OS_LINUX
+qint64 statmResidentKiB(const QString &pid) {
+  QFile file("/proc/" + pid + "/statm");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+  // size resident shared text lib data dt, in pages
+  QList<QByteArray> fields = file.readAll().split(' ');
+  return fields.size() > 1
+             ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024
+             : -1;
+}
+
+// The process's share of the pages it maps: the renderers and the zygote
+// share most of theirs, and their resident sizes would count those pages
+// once per process. Falls back to the resident size on kernels older than
+// 4.14, which have no smaps_rollup.
+qint64 proportionalKiB(const QString &pid) {
+  QFile file("/proc/" + pid + "/smaps_rollup");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return statmResidentKiB(pid);
+  }
+  // "Pss:    1234 kB", among the other totals.
+  for (const QByteArray &line : file.readAll().split('\n')) {
+    if (line.startsWith("Pss:")) {
+      return line.mid(4).simplified().split(' ').value(0).toLongLong();
+    }
+  }
+  return -1;
+}
+#endif
+
+qint64 parentPid(const QString &pid) {
+  QFile file("/proc/" + pid + "/stat");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+  // pid (comm) state ppid ..., comm may contain spaces and parentheses.
+  QByteArray stat = file.readAll();
+  QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+  return fields.size() > 1 ? fields[1].toLongLong() : -1;
+}
+
+} // namespace
+
+MemoryMonitor::MemoryMonitor(MainWindow *window, int interval,
+                             const QList<int> &thresholds, QObject *parent)
+    : QObject(parent), m_window(window), m_thresholds(thresholds) {
+  while (m_thresholds.size() < StepCount) {
+    m_thresholds.append(0);
+  }
+
+  m_timer.setInterval(interval);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(sample()));
+
+  m_reportTimer.setSingleShot(true);
+  m_reportTimer.setInterval(reportDelay);
+  connect(&m_reportTimer, SIGNAL(timeout()), this, SLOT(reportAction()));
+}
+
+void MemoryMonitor::start() {
+  if (usedKiB() < 0) {
+    qDebug() << "Memory monitor: /proc not available, disabled";
+    return;
+  }
+  m_timer.start();
+}
+
+qint64 MemoryMonitor::usedKiB() {
+#ifdef Q_OS_LINUX
+  const QString self = QString::number(QCoreApplication::applicationPid());
+  qint64 total = proportionalKiB(self);
+  if (total < 0) {
+    return -1;
+  }
+
+  // Renderers are forked from the zygote, so the whole tree below this
+  // process is walked rather than just its children.
+  QHash<qint64, QVector<QString>> children;
+  for (const auto &pid :
+       QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+    if (pid[0].isDigit()) {
+      children[parentPid(pid)].append(pid);
+    }
+  }
+
+  QVector<QString> pending = children.value(self.toLongLong());
+  while (!pending.isEmpty()) {
+    QString pid = pending.takeLast();
+    total += qMax<qint64>(proportionalKiB(pid), 0);
+    pending += children.value(pid.toLongLong());
+  }
+
+  return total;
+#else
+  return -1;
+#endif
+}
+
+void MemoryMonitor::sample() {
+  qint64 used = usedKiB();
+  if (used < 0 || m_reportTimer.isActive()) {
+    return;
+  }
+  qint64 mib = used / 1024;
+
+  int lowest = 0;
+  for (int threshold : m_thresholds) {
+    if (threshold > 0 && (lowest == 0 || threshold < lowest)) {
+      lowest = threshold;
+    }
+  }
+  if (lowest == 0 || mib < lowest) {
+    if (m_nextStep > 0) {
+      qDebug() << "Memory monitor: back to" << mib << "MiB, steps re-armed";
+    }
+    m_nextStep = 0;
+    return;
+  }
+
+  // One step per sample, so the effect of each can be seen before the next.
+  for (; m_nextStep < StepCount; ++m_nextStep) {
+    int threshold = m_thresholds[m_nextStep];
+    if (threshold <= 0) {
+      continue;
+    }
+    if (mib < threshold) {
+      return;
+    }
+    m_before = used;
+    m_lastStep = m_nextStep;
+    qDebug() << "Memory monitor:" << mib << "MiB over" << threshold
+             << "MiB," << stepName(m_nextStep);
+    apply(m_nextStep++);
+    m_reportTimer.start();
+    return;
+  }
+}
+
+void MemoryMonitor::apply(int step) {
+  switch (step) {
+  case ClearDiskCache:
+    // QtWebEngine has no call for the in-memory cache; this empties the
+    // cache directory and only frees the index the network service holds.
+    m_window->webView()->page()->profile()->clearHttpCache();
+    break;
+  case DiscardTabs: {
+    int discarded = 0;
+    for (auto tab : m_window->tabs()) {
+      if (tab->discard()) {
+        ++discarded;
+      }
+    }
+    qDebug() << "Memory monitor: discarded" << discarded << "tabs";
+    break;
+  }
+  case DropArtCache:
+    qDebug() << "Memory monitor: dropping" << m_window->artCache()->size()
+             << "cached titles";
+    // Written out first, so only memory is given up.
+    m_window->artCache()->save();
+    m_window->artCache()->clear();
+    break;
+  case Reload:
+    m_window->reloadAndResume();
+    break;
+  }
+}
+
+void MemoryMonitor::reportAction() {
+  qint64 after = usedKiB();
+  qDebug() << "Memory monitor:" << stepName(m_lastStep) << "- before"
+           << m_before / 1024 << "MiB, after" << after / 1024 << "MiB";
+}
+
+const char *MemoryMonitor::stepName(int step) {
+  switch (step) {
+  case ClearDiskCache:
+    return "clearing the HTTP disk cache";
+  case DiscardTabs:
+    return "discarding background tabs";
+  case DropArtCache:
+    return "dropping the title art cache";
+  case Reload:
+    return "reloading the page";
+  default:
+    return "";
+  }
+}
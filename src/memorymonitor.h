@@ -0,0 +1,57 @@
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+
+class MainWindow;
+
+// Samples the memory used by qtwebflix and its QtWebEngineProcess
+// descendants from /proc and sheds memory in escalating steps once it
+// passes the configured thresholds:
+//
+//   1. clear the HTTP disk cache, which frees little resident memory and
+//      costs re-downloads, so it is disabled by default
+//   2. discard background tabs
+//   3. drop the in-memory title art cache
+//   4. reload the foreground page, resuming playback where it was
+//
+// Each step is taken at most once until usage falls below the lowest
+// threshold again, and is logged with the usage before and after.
+class MemoryMonitor : public QObject {
+  Q_OBJECT
+
+public:
+  // `thresholds` are in MiB, one per step, 0 disables a step.
+  MemoryMonitor(MainWindow *window, int interval, const QList<int> &thresholds,
+                QObject *parent = nullptr);
+
+  void start();
+
+  // Proportional set size of the process tree in KiB, which counts pages
+  // shared between the processes once in total. -1 if unavailable.
+  static qint64 usedKiB();
+
+private slots:
+  void sample();
+  void reportAction();
+
+private:
+  enum Step { ClearDiskCache, DiscardTabs, DropArtCache, Reload, StepCount };
+
+  static const char *stepName(int step);
+  void apply(int step);
+
+  MainWindow *m_window;
+  QList<int> m_thresholds;
+  QTimer m_timer;
+  // Steps taken since usage was last below the lowest threshold.
+  int m_nextStep = 0;
+
+  // For logging the effect of the last step.
+  QTimer m_reportTimer;
+  int m_lastStep = -1;
+  qint64 m_before = 0;
+};
+
+#endif // MEMORYMONITOR_H
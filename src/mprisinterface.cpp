@@ -1,30 +1,236 @@
+#include <QDebug>
+#include <QEvent>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
 #include <QWidget>
+#include <qnumeric.h>
 
 #include "mainwindow.h"
 #include "mprisinterface.h"
+#include "videobridge.h"
 
-MprisInterface::MprisInterface(QWidget *parent)
-    : QObject(parent) {
+namespace {
+
+const QString controllerScriptName = QStringLiteral("qtwebflix-controller");
+
+// Observed positions further than this from the extrapolated one (in
+// microseconds) are treated as a seek.
+const qlonglong driftThreshold = 1000 * 1000;
+
+// Position requests closer than this to the current position (in
+// microseconds) are not worth a seek.
+const qlonglong positionTolerance = 50 * 1000;
+
+// Microseconds in `seconds`, -1 for negative, unknown (NaN) or unbounded
+// (Infinity, a live stream) times, which do not fit a qlonglong.
+qlonglong toUseconds(double seconds) {
+  return !qIsFinite(seconds) || seconds < 0 ? -1 : seconds / 1e-6;
+}
+
+// How long a position or volume sent to the page is taken as on its way
+// when the page never reports it, in ms.
+const int sentTimeout = 2000;
+
+bool inFlight(const QElapsedTimer &sent) {
+  return sent.isValid() && !sent.hasExpired(sentTimeout);
+}
+
+// How often the stored Position is refreshed from the model while playing,
+// in ms. qtmpris answers Position reads from the stored value, there is no
+// hook to compute it on demand.
+const int positionRefreshInterval = 250;
+
+// Keys and names used on every snapshot, created once rather than per tick.
+const QString &metadataKey(Mpris::Metadata key) {
+  static const QString length = Mpris::metadataToString(Mpris::Length);
+  static const QString title = Mpris::metadataToString(Mpris::Title);
+  static const QString trackId = Mpris::metadataToString(Mpris::TrackId);
+  static const QString artUrl = Mpris::metadataToString(Mpris::ArtUrl);
+  switch (key) {
+  case Mpris::Length:
+    return length;
+  case Mpris::Title:
+    return title;
+  case Mpris::TrackId:
+    return trackId;
+  default:
+    return artUrl;
+  }
+}
+
+} // namespace
+
+MprisInterface::MprisInterface(const Provider &provider, QWidget *parent)
+    : QObject(parent), m_provider(provider) {
+  m_call.reserve(64);
+  m_positionTimer.setInterval(positionRefreshInterval);
+  connect(&m_positionTimer, SIGNAL(timeout()), this, SLOT(refreshPosition()));
+  connect(&m_commands, SIGNAL(seekReady(qlonglong)), this,
+          SLOT(sendSeek(qlonglong)));
+  connect(&m_commands, SIGNAL(positionReady(qlonglong)), this,
+          SLOT(sendPosition(qlonglong)));
+  connect(&m_commands, SIGNAL(volumeReady(double)), this,
+          SLOT(sendVolume(double)));
+}
+
+MprisInterface::~MprisInterface() {
 }
 
-void MprisInterface::setup(MainWindow *window) {
+void MprisInterface::setup(MainWindow *window, MprisPlayerHost *host) {
   m_window = window;
+  m_host = host;
+}
 
- //testing setting service name in the seperate interfaces
-  workWithPlayer([] (MprisPlayer& p) {
-    p.setServiceName("QtWebFlix");
+void MprisInterface::attach() {
+  m_attached = true;
+
+  workWithPlayer([this] (MprisPlayer& p) {
+    connect(&p, SIGNAL(pauseRequested()), this, SLOT(pauseVideo()));
+    connect(&p, SIGNAL(playRequested()), this, SLOT(playVideo()));
+    connect(&p, SIGNAL(playPauseRequested()), this, SLOT(togglePlayPause()));
+    connect(&p, SIGNAL(fullscreenRequested(bool)), this,
+            SLOT(setFullScreen(bool)));
+    connect(&p, SIGNAL(volumeRequested(double)), this,
+            SLOT(setVideoVolume(double)));
+    connect(&p, SIGNAL(setPositionRequested(QDBusObjectPath, qlonglong)), this,
+            SLOT(setPosition(QDBusObjectPath, qlonglong)));
+    connect(&p, SIGNAL(seekRequested(qlonglong)), this,
+            SLOT(setSeek(qlonglong)));
   });
+
+  publish(QStringLiteral("Identity"), m_provider.identity,
+          [this](MprisPlayer &p) { p.setIdentity(m_provider.identity); });
+
+  m_bridge = m_window->videoBridge();
+  connect(m_bridge, &VideoBridge::videoStateChanged, this,
+          &MprisInterface::videoStateChanged);
+
+  // Follow the window's visibility so that polling can back off.
+  m_window->installEventFilter(this);
+  m_scheduler.setWindowVisible(m_window->isVisible() &&
+                               !m_window->isMinimized());
+
+  installController();
+  updatePlayerFullScreen();
+
+  // State, position and volume are pushed by the video bridge. One snapshot
+  // per tick picks up the metadata and resyncs anything the bridge missed.
+  if (m_provider.pollInterval > 0) {
+    startPolling(m_provider.pollInterval);
+  }
+}
+
+void MprisInterface::detach() {
+  m_attached = false;
+
+  workWithPlayer(
+      [this](MprisPlayer &p) { disconnect(&p, nullptr, this, nullptr); });
+  // The bridge of the tab attached to, which may be gone or in the
+  // background by now.
+  if (m_bridge) {
+    disconnect(m_bridge, nullptr, this, nullptr);
+  }
+  m_window->removeEventFilter(this);
+
+  // Requests and results still pending concern the page detached from.
+  m_commands.clear();
+  qDebug() << "Merged" << m_commands.received() << "seek, position and volume"
+           << "requests into" << m_commands.sent() << "commands";
+  m_queries.cancel();
+  m_queries.logStatistics();
+
+  m_scheduler.stop();
+  m_positionTimer.stop();
+  m_positionModel.invalidate();
+  m_resumePosition = -1;
+  m_volume = -1;
+  m_sentPositionAt.invalidate();
+  m_sentVolumeAt.invalidate();
+  m_metadata = SnapshotMetadata();
+  m_host->reset();
+}
+
+bool MprisInterface::isAttached() const { return m_attached; }
+
+const CommandQueue &MprisInterface::commands() const { return m_commands; }
+
+void MprisInterface::installController() {
+  // Registered on the page so that every document it loads from now on gets
+  // the controller before any of the page's own scripts run. The profile is
+  // shared by all tabs, which may belong to different providers.
+  QString prelude =
+      QStringLiteral("window.__qwfProvider = %1;\n")
+          .arg(QString::fromUtf8(
+              QJsonDocument(QJsonObject{
+                                {"name", m_provider.name},
+                                {"selectors", QJsonObject::fromVariantMap(
+                                                  m_provider.selectors)}})
+                  .toJson(QJsonDocument::Compact)));
+  QString source = m_window->scriptAssets()->install(
+      webView()->page()->scripts(), controllerScriptName,
+      scriptAssets() << controllerScript(), scriptWorld(), prelude);
+  if (source.isNull()) {
+    return;
+  }
+
+  // The current document already exists, install the controller there too.
+  webView()->page()->runJavaScript(source, scriptWorld());
+}
+
+QString MprisInterface::controllerScript() const {
+  return m_provider.controller;
+}
+
+QStringList MprisInterface::scriptAssets() const { return m_provider.assets; }
+
+quint32 MprisInterface::scriptWorld() const {
+  return m_provider.mainWorld ? QWebEngineScript::MainWorld
+                              : QWebEngineScript::ApplicationWorld;
+}
+
+void MprisInterface::callController(const QString &call) {
+  webView()->page()->runJavaScript(call, scriptWorld());
+}
+
+void MprisInterface::callController(const QString &prefix, double argument,
+                                    int decimals) {
+  // Fixed point through integers, which unlike printf("%f") does not depend
+  // on the C locale's decimal separator.
+  qlonglong scale = 1;
+  for (int i = 0; i < decimals; ++i) {
+    scale *= 10;
+  }
+  qlonglong scaled = qRound64(argument * scale);
+  char number[48];
+  qsnprintf(number, sizeof(number), "%s%lld.%0*lld)", scaled < 0 ? "-" : "",
+            qAbs(scaled) / scale, decimals, qAbs(scaled) % scale);
+
+  m_call.resize(0);
+  m_call.append(prefix);
+  m_call.append(QLatin1String(number));
+  callController(m_call);
+}
+
+bool MprisInterface::query(const QString &kind, const QString &script,
+                           PageQueries::Callback callback) {
+  return m_queries.run(webView()->page(), scriptWorld(), kind, script,
+                       std::move(callback));
 }
 
 
 void MprisInterface::workWithPlayer(std::function<void(MprisPlayer&)> callback) {
-  std::lock_guard<std::mutex> l(m_mtx_player);
+  m_host->workWithPlayer(callback);
+}
 
-  // This should be the ONLY point where `m_player` is accessed.
-  // For anything else, use `workWithPlayer()`.
-  callback(m_player);
+void MprisInterface::publish(const QString &property, const QVariant &value,
+                             std::function<void(MprisPlayer &)> setter) {
+  m_host->publish(property, value, setter);
 }
 
+const Provider &MprisInterface::provider() const { return m_provider; }
+
 MainWindow * MprisInterface::window() const {
   return m_window;
 }
@@ -34,8 +240,287 @@ QWebEngineView * MprisInterface::webView() const {
 }
 
 void MprisInterface::updatePlayerFullScreen() {
-  workWithPlayer([this] (MprisPlayer& p) {
-    p.setFullscreen(m_window->isFullScreen());
-  });
+  bool fullscreen = m_window->isFullScreen();
+  publish(QStringLiteral("Fullscreen"), fullscreen,
+          [&](MprisPlayer &p) { p.setFullscreen(fullscreen); });
 }
 
+void MprisInterface::videoStateChanged(const QString &type,
+                                       const QVariantMap &state) {
+  applyVideoState(type, state);
+}
+
+void MprisInterface::startPolling(int interval) {
+  connect(&m_scheduler, SIGNAL(tick()), this, SLOT(pollTimerFired()),
+          Qt::UniqueConnection);
+  m_scheduler.setBaseInterval(interval);
+}
+
+bool MprisInterface::eventFilter(QObject *watched, QEvent *event) {
+  switch (event->type()) {
+  case QEvent::Show:
+  case QEvent::Hide:
+  case QEvent::WindowStateChange:
+    m_scheduler.setWindowVisible(m_window->isVisible() &&
+                                 !m_window->isMinimized());
+    break;
+  default:
+    break;
+  }
+  return QObject::eventFilter(watched, event);
+}
+
+void MprisInterface::pollTimerFired() {
+  // Skipped while the last snapshot is still on its way.
+  query(QStringLiteral("snapshot"), snapshotScript(),
+        [this](const QVariant &result) {
+          // Null until the controller is installed in the current document.
+          // A detached provider must not touch the shared player.
+          if (isAttached() && !result.isNull()) {
+            applySnapshot(result.toMap());
+          }
+        });
+}
+
+QString MprisInterface::snapshotScript() const {
+  return ControllerScript<ControllerCall::Snapshot>::source();
+}
+
+void MprisInterface::applySnapshot(const QVariantMap &snapshot) {
+  applyVideoState(QStringLiteral("snapshot"), snapshot);
+
+  qlonglong lengthUseconds =
+      toUseconds(snapshot[QStringLiteral("duration")].toDouble());
+  QString title = snapshot[QStringLiteral("title")].toString();
+  QString nid = snapshot[QStringLiteral("nid")].toString();
+  QString art = nid.isEmpty() ? QString() : artUrl(nid, snapshot);
+
+  // Nearly every tick sees the same video, and the Metadata published for
+  // it still stands.
+  if (m_metadata.published && m_metadata.length == lengthUseconds &&
+      m_metadata.title == title && m_metadata.nid == nid &&
+      m_metadata.art == art) {
+    return;
+  }
+  m_metadata.published = true;
+  m_metadata.length = lengthUseconds;
+  m_metadata.title = title;
+  m_metadata.nid = nid;
+  m_metadata.art = art;
+
+  QVariantMap metadata;
+  if (lengthUseconds >= 0) {
+    metadata[metadataKey(Mpris::Length)] = QVariant(lengthUseconds);
+  }
+  if (!title.isEmpty()) {
+    metadata[metadataKey(Mpris::Title)] = QVariant(title);
+  }
+  if (!nid.isEmpty()) {
+    metadata[metadataKey(Mpris::TrackId)] =
+        QVariant(trackIdPrefix() + nid);
+    if (!art.isEmpty()) {
+      metadata[metadataKey(Mpris::ArtUrl)] = QVariant(art);
+    }
+  }
+
+  publish(QStringLiteral("Metadata"), metadata,
+          [&](MprisPlayer &p) { p.setMetadata(metadata); });
+}
+
+void MprisInterface::applyVideoState(const QString &type,
+                                     const QVariantMap &state) {
+  Mpris::PlaybackStatus status =
+      playbackStatusFromString(state[QStringLiteral("state")].toString());
+
+  if (m_resumePosition >= 0 && status == Mpris::Playing) {
+    qlonglong position = m_resumePosition;
+    m_resumePosition = -1;
+    setPosition(QDBusObjectPath(), position);
+  }
+
+  double position = state[QStringLiteral("position")].toDouble();
+  double seconds = position < 0 ? -1 : position + positionOffset();
+  qlonglong useconds = toUseconds(seconds);
+
+  double volume = state[QStringLiteral("volume")].toDouble();
+  double rate = state[QStringLiteral("rate")].toDouble();
+
+  m_scheduler.setPlaybackStatus(status);
+
+  publish(QStringLiteral("PlaybackStatus"), static_cast<int>(status),
+          [&](MprisPlayer &p) { p.setPlaybackStatus(status); });
+  if (volume >= 0) {
+    m_volume = volume;
+    if (qFuzzyCompare(volume + 1, m_sentVolume + 1)) {
+      m_sentVolumeAt.invalidate();
+    }
+    publish(QStringLiteral("Volume"), volume,
+            [&](MprisPlayer &p) { p.setVolume(volume); });
+  }
+  if (rate > 0) {
+    publish(QStringLiteral("Rate"), rate,
+            [&](MprisPlayer &p) { p.setRate(rate); });
+  }
+
+  updatePosition(type, useconds, rate, status == Mpris::Playing);
+}
+
+void MprisInterface::updatePosition(const QString &type, qlonglong observed,
+                                    double rate, bool playing) {
+  if (observed < 0) {
+    m_positionModel.invalidate();
+  } else {
+    if (rate <= 0) {
+      rate = m_positionModel.rate();
+    }
+
+    // The model only moves on state and rate changes, seeks and drift.
+    // Everything else is answered by extrapolation, as MPRIS clients do.
+    bool seeked = type == QLatin1String("seeked");
+    bool reanchor = seeked || !m_positionModel.isValid() ||
+                    m_positionModel.playing() != playing ||
+                    m_positionModel.rate() != rate;
+    if (!reanchor && qAbs(m_positionModel.drift(observed)) > driftThreshold) {
+      qDebug() << "Position drifted by"
+               << m_positionModel.drift(observed) / 1000 << "ms";
+      reanchor = seeked = true;
+    }
+
+    if (reanchor) {
+      m_positionModel.anchor(observed, rate, playing);
+    }
+    if (qAbs(observed - m_sentPosition) < positionTolerance) {
+      m_sentPositionAt.invalidate();
+    }
+    if (seeked) {
+      workWithPlayer([&](MprisPlayer &p) { emit p.seeked(observed); });
+    }
+  }
+
+  // Between events the stored value is kept current by m_positionTimer.
+  if (m_positionModel.isValid() && playing) {
+    // Restarting would register the timer anew on every event.
+    if (!m_positionTimer.isActive()) {
+      m_positionTimer.start();
+    }
+  } else {
+    m_positionTimer.stop();
+  }
+  refreshPosition();
+}
+
+void MprisInterface::refreshPosition() {
+  // MPRIS does not signal Position changes, so keeping the stored value
+  // current costs nothing on the bus, and nothing is asked of the page.
+  qlonglong position = m_positionModel.position();
+  publish(QStringLiteral("Position"), position,
+          [&](MprisPlayer &p) { p.setPosition(position); });
+}
+
+qlonglong MprisInterface::position() const {
+  return m_positionModel.position();
+}
+
+void MprisInterface::resumeAt(qlonglong position) {
+  m_resumePosition = position;
+}
+
+void MprisInterface::playVideo() {
+  qDebug() << "Player playing";
+  callController<ControllerCall::Play>();
+}
+
+void MprisInterface::pauseVideo() {
+  qDebug() << "Player paused";
+  callController<ControllerCall::Pause>();
+}
+
+void MprisInterface::togglePlayPause() {
+  qDebug() << "Player toggled play/pause";
+  callController<ControllerCall::Toggle>();
+}
+
+void MprisInterface::setVideoVolume(double volume) {
+  m_commands.setVolume(volume);
+}
+
+void MprisInterface::setFullScreen(bool fullscreen) {
+  window()->setFullScreen(fullscreen);
+}
+
+void MprisInterface::setPosition(QDBusObjectPath trackId, qlonglong pos) {
+  Q_UNUSED(trackId);
+  m_scheduler.positionWatched();
+  m_commands.setPosition(pos);
+}
+
+void MprisInterface::setSeek(qlonglong seekPos) {
+  m_scheduler.positionWatched();
+  m_commands.seek(seekPos);
+}
+
+void MprisInterface::sendSeek(qlonglong offset) {
+  double seconds = offset / 1e+6;
+  qDebug() << "Seeking Position by " << seconds << " Seconds";
+  callController<ControllerCall::Seek>(seconds);
+  // Moves away from any position still on its way.
+  m_sentPositionAt.invalidate();
+}
+
+void MprisInterface::sendPosition(qlonglong position) {
+  // Already there or already asked for. What the page last reported may
+  // predate a position sent moments ago, so that one is compared against
+  // until the page reports it.
+  qlonglong current = -1;
+  if (inFlight(m_sentPositionAt)) {
+    current = m_sentPosition;
+  } else if (m_positionModel.isValid()) {
+    current = m_positionModel.position();
+  }
+  if (current >= 0 && qAbs(position - current) < positionTolerance) {
+    return;
+  }
+  double seconds = position / 1e+6;
+  qDebug() << "set Position to " << seconds << " Seconds";
+  callController<ControllerCall::SetPosition>(seconds);
+  m_sentPosition = position;
+  m_sentPositionAt.start();
+}
+
+void MprisInterface::sendVolume(double volume) {
+  // Already there, e.g. a slider released where it was picked up, compared
+  // like positions are.
+  double current = inFlight(m_sentVolumeAt) ? m_sentVolume : m_volume;
+  if (qFuzzyCompare(volume + 1, current + 1)) {
+    return;
+  }
+  qDebug() << "Player set volume to " << volume;
+  callController<ControllerCall::SetVolume>(volume);
+  m_sentVolume = volume;
+  m_sentVolumeAt.start();
+}
+
+double MprisInterface::positionOffset() const {
+  return m_provider.positionOffset;
+}
+
+QString MprisInterface::trackIdPrefix() const {
+  return m_provider.trackIdPrefix;
+}
+
+QString MprisInterface::artUrl(const QString &nid,
+                               const QVariantMap &snapshot) {
+  Q_UNUSED(nid);
+  return snapshot[QStringLiteral("arturl")].toString();
+}
+
+Mpris::PlaybackStatus
+MprisInterface::playbackStatusFromString(const QString &state) {
+  if (state == QLatin1String("stopped"))
+    return Mpris::Stopped;
+  if (state == QLatin1String("playing"))
+    return Mpris::Playing;
+  if (state == QLatin1String("paused"))
+    return Mpris::Paused;
+  return Mpris::InvalidPlaybackStatus;
+}
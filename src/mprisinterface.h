@@ -2,36 +2,172 @@
 #define MPRISINTERFACE_H
 
 #include <functional>
-#include <mutex>
 
 #include <Mpris>
 #include <MprisPlayer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantMap>
 #include <QWebEngineView>
 
+#include "commandqueue.h"
+#include "controllerscripts.h"
+#include "mprisplayerhost.h"
+#include "pagequeries.h"
+#include "pollscheduler.h"
+#include "positionmodel.h"
+#include "providerregistry.h"
+
 class MainWindow;
+class VideoBridge;
 
 class MprisInterface : public QObject {
   Q_OBJECT
 
 public:
-  explicit MprisInterface(QWidget *parent = nullptr);
-  virtual ~MprisInterface() = default;
+  explicit MprisInterface(const Provider &provider, QWidget *parent = nullptr);
+  virtual ~MprisInterface();
+
+  // Called once, before the first attach().
+  virtual void setup(MainWindow *window, MprisPlayerHost *host);
 
-  virtual void setup(MainWindow *window);
+  // Backends are kept across provider switches. While attached, a backend
+  // drives the shared player and receives its requests; detaching stops its
+  // timers and resets its state for the next attach().
+  virtual void attach();
+  virtual void detach();
+  bool isAttached() const;
+  // Merging of the seek, position and volume requests received so far.
+  const CommandQueue &commands() const;
 
   void updatePlayerFullScreen();
 
+  const Provider &provider() const;
+
+  // Playback position in microseconds, extrapolated without asking the page.
+  qlonglong position() const;
+  // Seeks to `position` once a video plays again, e.g. after a reload.
+  void resumeAt(qlonglong position);
+
+protected slots:
+  // Pushed by the VideoBridge whenever the page's <video> changes state.
+  virtual void videoStateChanged(const QString &type, const QVariantMap &state);
+
+  // slots for handlers of hotkeys
+  void playVideo();
+  void pauseVideo();
+  void togglePlayPause();
+  void setVideoVolume(double volume);
+  void setFullScreen(bool fullscreen);
+  void setPosition(QDBusObjectPath trackId, qlonglong pos);
+  void setSeek(qlonglong seekPos);
+
 protected:
   void workWithPlayer(std::function<void(MprisPlayer &)> callback);
+  // See MprisPlayerHost::publish().
+  void publish(const QString &property, const QVariant &value,
+               std::function<void(MprisPlayer &)> setter);
   MainWindow *window() const;
   QWebEngineView *webView() const;
 
+  // Path of the script installing this provider's `__qwf` controller, see
+  // resources/scripts/controller.js.
+  virtual QString controllerScript() const;
+  // Bundled scripts the controller script builds on, see ScriptAssets.
+  virtual QStringList scriptAssets() const;
+  // World the controller is installed in and all calls into it run in.
+  virtual quint32 scriptWorld() const;
+
+  // Evaluates `call` against the page's `__qwf` controller.
+  template <ControllerCall call> void callController() {
+    static_assert(ControllerScript<call>::decimals < 0,
+                  "call takes an argument");
+    callController(ControllerScript<call>::source());
+  }
+  template <ControllerCall call> void callController(double argument) {
+    static_assert(ControllerScript<call>::decimals >= 0,
+                  "call takes no argument");
+    callController(ControllerScript<call>::source(), argument,
+                   ControllerScript<call>::decimals);
+  }
+  // Evaluates `script` for its result, unless a query of `kind` is still in
+  // flight, see PageQueries. Returns whether the query was run.
+  bool query(const QString &kind, const QString &script,
+             PageQueries::Callback callback);
+
+  // Samples the page with `snapshotScript()` and hands the result to
+  // `applySnapshot()`. `interval` is the rate used while playing in a visible
+  // window, see PollScheduler for the others.
+  void startPolling(int interval);
+
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+  // JavaScript evaluating to an object with state, position, duration,
+  // volume, rate, title and nid of the current video, gathered in one pass.
+  virtual QString snapshotScript() const;
+  virtual void applySnapshot(const QVariantMap &snapshot);
+
+  // Seconds added to the position reported by the page.
+  virtual double positionOffset() const;
+  virtual QString trackIdPrefix() const;
+  virtual QString artUrl(const QString &nid, const QVariantMap &snapshot);
+
+  static Mpris::PlaybackStatus playbackStatusFromString(const QString &state);
+
   friend class MainWindow;
 
+private slots:
+  void pollTimerFired();
+  // Merged requests from m_commands, sent to the page.
+  void sendSeek(qlonglong offset);
+  void sendPosition(qlonglong position);
+  void sendVolume(double volume);
+  // Publishes the model's position, see m_positionTimer.
+  void refreshPosition();
+
 private:
-  MainWindow *m_window;
-  std::mutex m_mtx_player;
-  MprisPlayer m_player;
+  void callController(const QString &call);
+  // Appends `argument` and a closing parenthesis to the `prefix` of a call.
+  void callController(const QString &prefix, double argument, int decimals);
+  void installController();
+  // `type` is the media event that produced `state`, or "snapshot".
+  void applyVideoState(const QString &type, const QVariantMap &state);
+  void updatePosition(const QString &type, qlonglong observed, double rate,
+                      bool playing);
+
+  const Provider m_provider;
+  MainWindow *m_window = nullptr;
+  MprisPlayerHost *m_host = nullptr;
+  bool m_attached = false;
+  QPointer<VideoBridge> m_bridge;
+  qlonglong m_resumePosition = -1;
+  PollScheduler m_scheduler;
+  PositionModel m_positionModel;
+  // Runs while playing so that Position reads are answered from the model
+  // rather than from the last snapshot.
+  QTimer m_positionTimer;
+  CommandQueue m_commands;
+  PageQueries m_queries;
+  // What the Metadata last published from a snapshot was built from.
+  struct SnapshotMetadata {
+    bool published = false;
+    qlonglong length = -1;
+    QString title;
+    QString nid;
+    QString art;
+  };
+  SnapshotMetadata m_metadata;
+  // Calls taking an argument are put together here, reusing its capacity.
+  QString m_call;
+  // Last volume reported by the page, -1 if unknown.
+  double m_volume = -1;
+  // Last position and volume sent to the page, on their way until it
+  // reports them or sentTimeout passes.
+  qlonglong m_sentPosition = -1;
+  QElapsedTimer m_sentPositionAt;
+  double m_sentVolume = -1;
+  QElapsedTimer m_sentVolumeAt;
 };
 
 #endif // MPRISINTERFACE_H
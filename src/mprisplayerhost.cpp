@@ -0,0 +1,53 @@
+#include <QDebug>
+
+#include "mprisplayerhost.h"
+
+MprisPlayerHost::MprisPlayerHost() {
+  workWithPlayer([](MprisPlayer &p) {
+    p.setServiceName("QtWebFlix");
+
+    // Expose player capabilities.
+    p.setCanQuit(true);
+    p.setCanSetFullscreen(true);
+    p.setCanPause(true);
+    p.setCanPlay(true);
+    p.setCanControl(true);
+    p.setCanSeek(true);
+    p.setMetadata(QVariantMap());
+  });
+}
+
+MprisPlayerHost::~MprisPlayerHost() {
+  qDebug() << "MPRIS property updates:" << m_propertyCache.emitted()
+           << "emitted," << m_propertyCache.suppressed() << "suppressed";
+}
+
+void MprisPlayerHost::workWithPlayer(
+    std::function<void(MprisPlayer &)> callback) {
+  std::lock_guard<std::mutex> l(m_mutex);
+
+  // This and `publish()` should be the ONLY points where `m_player` is
+  // accessed. For anything else, use `workWithPlayer()`.
+  callback(m_player);
+}
+
+void MprisPlayerHost::publish(const QString &property, const QVariant &value,
+                              std::function<void(MprisPlayer &)> setter) {
+  // Locked here rather than through workWithPlayer(), whose callback would
+  // capture too much to be stored without allocating on every tick.
+  std::lock_guard<std::mutex> l(m_mutex);
+  if (m_propertyCache.update(property, value)) {
+    setter(m_player);
+  }
+}
+
+void MprisPlayerHost::reset() {
+  publish("Metadata", QVariantMap(),
+          [](MprisPlayer &p) { p.setMetadata(QVariantMap()); });
+  publish("PlaybackStatus", static_cast<int>(Mpris::Stopped),
+          [](MprisPlayer &p) { p.setPlaybackStatus(Mpris::Stopped); });
+  publish("Position", qlonglong(0),
+          [](MprisPlayer &p) { p.setPosition(0); });
+  publish("CanGoNext", false,
+          [](MprisPlayer &p) { p.setCanGoNext(false); });
+}
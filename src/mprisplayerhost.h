@@ -0,0 +1,36 @@
+#ifndef MPRISPLAYERHOST_H
+#define MPRISPLAYERHOST_H
+
+#include <functional>
+#include <mutex>
+
+#include <MprisPlayer>
+#include <QString>
+#include <QVariant>
+
+#include "mprispropertycache.h"
+
+// The application's one MprisPlayer. Provider backends attach to it in turn,
+// so the D-Bus service stays registered, and clients keep their proxies,
+// across provider switches.
+class MprisPlayerHost {
+public:
+  MprisPlayerHost();
+  ~MprisPlayerHost();
+
+  void workWithPlayer(std::function<void(MprisPlayer &)> callback);
+  // Runs `setter` only if `value` differs from the value last published for
+  // `property`, so unchanged values cause no D-Bus traffic.
+  void publish(const QString &property, const QVariant &value,
+               std::function<void(MprisPlayer &)> setter);
+
+  // Withdraws what the detached backend published.
+  void reset();
+
+private:
+  std::mutex m_mutex;
+  MprisPlayer m_player;
+  MprisPropertyCache m_propertyCache;
+};
+
+#endif // MPRISPLAYERHOST_H
@@ -0,0 +1,22 @@
+#include "mprispropertycache.h"
+
+MprisPropertyCache::MprisPropertyCache() : m_emitted(0), m_suppressed(0) {}
+
+bool MprisPropertyCache::update(const QString &property,
+                                const QVariant &value) {
+  auto it = m_values.find(property);
+  if (it != m_values.end() && it.value() == value) {
+    ++m_suppressed;
+    return false;
+  }
+
+  m_values.insert(property, value);
+  ++m_emitted;
+  return true;
+}
+
+void MprisPropertyCache::clear() { m_values.clear(); }
+
+qint64 MprisPropertyCache::emitted() const { return m_emitted; }
+
+qint64 MprisPropertyCache::suppressed() const { return m_suppressed; }
@@ -0,0 +1,28 @@
+#ifndef MPRISPROPERTYCACHE_H
+#define MPRISPROPERTYCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QVariant>
+
+// Remembers the last value published for each MprisPlayer property, so that
+// repeated values do not turn into PropertiesChanged signals on the bus.
+class MprisPropertyCache {
+public:
+  MprisPropertyCache();
+
+  // Returns true and remembers `value` if it differs from the value last
+  // published for `property`.
+  bool update(const QString &property, const QVariant &value);
+  void clear();
+
+  qint64 emitted() const;
+  qint64 suppressed() const;
+
+private:
+  QHash<QString, QVariant> m_values;
+  qint64 m_emitted;
+  qint64 m_suppressed;
+};
+
+#endif // MPRISPROPERTYCACHE_H
@@ -1,311 +1,107 @@
 #include "netflixmprisinterface.h"
+#include "artcache.h"
 #include "mainwindow.h"
 #include "mprisinterface.h"
 #include <QDebug>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QStandardPaths>
 #include <QWebEngineProfile>
+#include <QWebEngineScript>
 #include <QWebEngineView>
 #include <QWidget>
 
-NetflixMprisInterface::NetflixMprisInterface(QWidget *parent)
-    : MprisInterface(parent) {
-  prevTitleId = "";
-  prevArtUrl = "";
-  titleInfoFetching = false;
-}
+namespace {
 
-void NetflixMprisInterface::setup(MainWindow *window) {
-  MprisInterface::setup(window);
+// Milliseconds before a title whose info could not be fetched is tried again.
+const qint64 titleRetryDelay = 10 * 60 * 1000;
 
-  workWithPlayer([this](MprisPlayer &p) {
-    // Expose player capabilities.
-    p.setCanQuit(true);
-    p.setCanSetFullscreen(true);
-    p.setCanPause(true);
-    p.setCanPlay(true);
-    p.setCanControl(true);
-    p.setCanSeek(true);
-    p.setMetadata(QVariantMap());
-
-    connect(&p, SIGNAL(pauseRequested()), this, SLOT(pauseVideo()));
-    connect(&p, SIGNAL(playRequested()), this, SLOT(playVideo()));
-    connect(&p, SIGNAL(playPauseRequested()), this, SLOT(togglePlayPause()));
-    connect(&p, SIGNAL(nextRequested()), this, SLOT(goNextEpisode()));
-    connect(&p, SIGNAL(fullscreenRequested(bool)), this,
-            SLOT(setFullScreen(bool)));
-    connect(&p, SIGNAL(volumeRequested(double)), this,
-            SLOT(setVideoVolume(double)));
-    connect(&p, SIGNAL(setPositionRequested(QDBusObjectPath, qlonglong)), this,
-            SLOT(setPosition(QDBusObjectPath, qlonglong)));
-    connect(&p, SIGNAL(seekRequested(qlonglong)), this,
-            SLOT(setSeek(qlonglong)));
-  });
+} // namespace
+
+NetflixMprisInterface::NetflixMprisInterface(const Provider &provider,
+                                             QWidget *parent)
+    : MprisInterface(provider, parent) {
+  auto cache = new QNetworkDiskCache(&networkManager);
+  cache->setCacheDirectory(
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      "/art");
+  networkManager.setCache(cache);
+}
+
+void NetflixMprisInterface::setup(MainWindow *window, MprisPlayerHost *host) {
+  MprisInterface::setup(window, host);
 
   connect(&networkManager, SIGNAL(finished(QNetworkReply *)), this,
           SLOT(networkManagerFinished(QNetworkReply *)));
 
-  // Connect slots and start timers.
-  connect(&playerStateTimer, SIGNAL(timeout()), this,
-          SLOT(playerStateTimerFired()));
-  playerStateTimer.start(500);
-
-  connect(&playerPositionTimer, SIGNAL(timeout()), this,
-          SLOT(playerPositionTimerFired()));
-  playerPositionTimer.start(170);
+  connect(&goNextTimer, SIGNAL(timeout()), this, SLOT(goNextTimerFired()));
+}
 
-  connect(&metadataTimer, SIGNAL(timeout()), this, SLOT(metadataTimerFired()));
-  metadataTimer.start(1000);
+void NetflixMprisInterface::attach() {
+  MprisInterface::attach();
 
-  connect(&volumeTimer, SIGNAL(timeout()), this, SLOT(volumeTimerFired()));
-  volumeTimer.start(220);
+  workWithPlayer([this](MprisPlayer &p) {
+    connect(&p, SIGNAL(nextRequested()), this, SLOT(goNextEpisode()));
+  });
 
-  connect(&goNextTimer, SIGNAL(timeout()), this, SLOT(goNextTimerFired()));
   goNextTimer.start(5000);
 }
 
-void NetflixMprisInterface::playVideo() {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "if (!vid) return;"
-                  "vid.play();"
-                  "})();");
-  qDebug() << "Player playing";
-  webView()->page()->runJavaScript(code);
-}
-
-void NetflixMprisInterface::pauseVideo() {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "if (!vid) return;"
-                  "vid.pause();"
-                  "})();");
-  qDebug() << "Player paused";
-  webView()->page()->runJavaScript(code);
-}
+void NetflixMprisInterface::detach() {
+  // Title pages already under way are still cached when they arrive.
+  goNextTimer.stop();
 
-void NetflixMprisInterface::togglePlayPause() {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "if (!vid) return;"
-                  "if (vid.paused) vid.play();"
-                  "else vid.pause();"
-                  "})();");
-  qDebug() << "Player toggled play/pause";
-  webView()->page()->runJavaScript(code);
+  MprisInterface::detach();
 }
 
 void NetflixMprisInterface::goNextEpisode() {
-
-  QString code = ("(function () {"
-                  "var goNext = "
-                  "document.querySelector('button.touchable.PlayerControls--"
-                  "control-element.nfp-button-control.default-control-button."
-                  "button-nfplayerNextEpisode');"
-                  "goNext.click();"
-                  "})()");
   qDebug() << "Next episode";
-  webView()->page()->runJavaScript(code);
+  callController<ControllerCall::Next>();
 }
 
-void NetflixMprisInterface::setVideoVolume(double volume) {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "if (!vid) return;"
-                  "vid.volume = " +
-                  QString::number(volume) +
-                  ";"
-                  "})();");
-  qDebug() << "Player set volume to " << volume;
-  webView()->page()->runJavaScript(code);
-}
-
-void NetflixMprisInterface::setFullScreen(bool fullscreen) {
-  window()->setFullScreen(fullscreen);
-}
-
-void NetflixMprisInterface::getVolume(std::function<void(double)> callback) {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "return vid ? vid.volume : -1;"
-                  "})()");
-  webView()->page()->runJavaScript(code, [callback](const QVariant &result) {
-    callback(result.toDouble());
-  });
+QString NetflixMprisInterface::artUrl(const QString &nid,
+                                      const QVariantMap &snapshot) {
+  return getArtUrl(nid, snapshot[QStringLiteral("title")].toString());
 }
 
-void NetflixMprisInterface::getVideoPosition(
-    std::function<void(qlonglong)> callback) {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "return vid ? vid.currentTime : -1;"
-                  "})()");
-  webView()->page()->runJavaScript(code, [callback](const QVariant &result) {
-    double seconds = result.toDouble();
-    if (seconds < 0)
-      callback(-1);
-    else
-      callback(seconds / 1e-6);
-  });
-}
-
-void NetflixMprisInterface::setPosition(QDBusObjectPath trackId,
-                                        qlonglong pos) {
-  double useconds = static_cast<double>(pos);
-  useconds = useconds / 1000;
-  qDebug() << "Seeking Position by " << useconds / 1000 << " Seconds";
-  QString code = ("(function () {"
-                  "const videoPlayer = netflix"
-                  ".appContext"
-                  ".state"
-                  ".playerApp"
-                  ".getAPI()"
-                  ".videoPlayer;"
-                  "const playerSessionId = videoPlayer"
-                  ".getAllPlayerSessionIds()[0];"
-                  "const player = videoPlayer"
-                  ".getVideoPlayerBySessionId(playerSessionId);"
-                  "player.seek(" +
-                  QString::number(useconds) +
-                  ");"
-                  "})();");
-  webView()->page()->runJavaScript(code);
-  qDebug("running");
-}
-
-void NetflixMprisInterface::setSeek(qlonglong seekPos) {
-  double useconds = static_cast<double>(seekPos);
-  useconds = useconds / 1000;
-  qDebug() << "Seeking Position by " << useconds / 1000 << " Seconds";
-  QString code = ("(function () {"
-                  "const videoPlayer = netflix"
-                  ".appContext"
-                  ".state"
-                  ".playerApp"
-                  ".getAPI()"
-                  ".videoPlayer;"
-                  "const playerSessionId = videoPlayer"
-                  ".getAllPlayerSessionIds()[0];"
-                  "const player = videoPlayer"
-                  ".getVideoPlayerBySessionId(playerSessionId);"
-                  "player.seek(player.getCurrentTime() +" +
-                  QString::number(useconds) +
-                  ");"
-                  "})();");
-  webView()->page()->runJavaScript(code);
-}
-void NetflixMprisInterface::getMetadata(
-    std::function<void(qlonglong, const QString &, const QString &)> callback) {
-  QString code =
-      ("(function () {"
-       "var vid = document.querySelector('video');"
-       "var titleLabel = "
-       "document.querySelector('.PlayerControls--control-element.video-title "
-       ".ellipsize-text');"
-       "var metadata = {};"
-       "metadata.duration = vid ? vid.duration : -1;"
-       "metadata.title = titleLabel ? "
-       "titleLabel.innerHTML.replace(/(<([^>]+)>)/g, \" \").replace(/ +(?= "
-       ")/g,'').replace(/ +(?= )/g,'').trim() : '';"
-       "metadata.nid = vid && vid.offsetParent ? vid.offsetParent.id : '';"
-       "return metadata;"
-       "})()");
-  webView()->page()->runJavaScript(code, [callback](const QVariant &result) {
-    QVariantMap map = result.toMap();
-
-    double seconds = map["duration"].toDouble();
-    if (seconds < 0)
-      seconds = -1;
-    else
-      seconds /= 1e-6;
-
-    QString title = map["title"].toString();
-    QString nid = map["nid"].toString();
-
-    callback(seconds, title, nid);
-  });
-}
+QString NetflixMprisInterface::getArtUrl(const QString &nid,
+                                         const QString &title) {
+  std::lock_guard<std::mutex> l(mtx_titleInfo);
 
-void NetflixMprisInterface::getVideoState(
-    std::function<void(Mpris::PlaybackStatus)> callback) {
-  QString code = ("(function () {"
-                  "var vid = document.querySelector('video');"
-                  "if (!vid) return 'stopped';"
-                  "return vid.paused ? 'paused' : 'playing';"
-                  "})()");
-  webView()->page()->runJavaScript(code, [callback](const QVariant &result) {
-    QString resultString = result.toString();
-    Mpris::PlaybackStatus status = Mpris::InvalidPlaybackStatus;
-    if (resultString == "stopped")
-      status = Mpris::Stopped;
-    else if (resultString == "playing")
-      status = Mpris::Playing;
-    else if (resultString == "paused")
-      status = Mpris::Paused;
-    callback(status);
-  });
-}
+  if (nid.isEmpty()) {
+    return QString();
+  }
 
-void NetflixMprisInterface::playerStateTimerFired() {
-  getVideoState([this](Mpris::PlaybackStatus state) {
-    workWithPlayer([&](MprisPlayer &p) { p.setPlaybackStatus(state); });
-  });
-}
+  ArtCacheEntry entry;
+  if (window()->artCache()->lookup(nid, &entry)) {
+    // The URL was retrieved earlier, possibly in a previous session.
+    return entry.artUrl;
+  }
 
-void NetflixMprisInterface::playerPositionTimerFired() {
-  getVideoPosition([this](qlonglong useconds) {
-    workWithPlayer([&](MprisPlayer &p) { p.setPosition(useconds); });
-  });
-}
+  fetchTitleInfo(nid, title, QNetworkRequest::NormalPriority);
 
-void NetflixMprisInterface::metadataTimerFired() {
-  getMetadata([this](qlonglong lengthUseconds, const QString &title,
-                     const QString &nid) {
-    workWithPlayer([&](MprisPlayer &p) {
-      QVariantMap metadata;
-      if (lengthUseconds >= 0) {
-        metadata[Mpris::metadataToString(Mpris::Length)] =
-            QVariant(lengthUseconds);
-      }
-      if (!title.isEmpty()) {
-        metadata[Mpris::metadataToString(Mpris::Title)] = QVariant(title);
-      }
-      if (!nid.isEmpty()) {
-        metadata[Mpris::metadataToString(Mpris::TrackId)] =
-            QVariant("/com/netflix/title/" + nid);
-        QString artUrl = getArtUrl(nid);
-        if (!artUrl.isEmpty()) {
-          metadata[Mpris::metadataToString(Mpris::ArtUrl)] = QVariant(artUrl);
-        }
-      }
-      p.setMetadata(metadata);
-    });
-  });
+  // The request's under way. Hopefully, next time around the response will have
+  // arrived.
+  return QString();
 }
 
-void NetflixMprisInterface::volumeTimerFired() {
-  getVolume([this](double volume) {
-    if (volume >= 0) {
-      workWithPlayer([&](MprisPlayer &p) { p.setVolume(volume); });
+void NetflixMprisInterface::fetchTitleInfo(const QString &nid,
+                                           const QString &title,
+                                           QNetworkRequest::Priority priority) {
+  for (const auto &fetch : titleInfoFetches) {
+    if (fetch.nid == nid) {
+      // GET request already in progress.
+      return;
     }
-  });
-}
-
-QString NetflixMprisInterface::getArtUrl(const QString &nid) {
-  std::lock_guard<std::mutex> l(mtx_titleInfo);
-
-  if (nid.isEmpty()) {
-    return QString();
-  }
-
-  if (nid == prevTitleId && !prevArtUrl.isEmpty()) {
-    // The URL was asynchronously retrieved earlier.
-    return prevArtUrl;
   }
 
-  if (titleInfoFetching) {
-    // GET request already in progress.
-    return QString();
+  auto failed = failedTitles.find(nid);
+  if (failed != failedTitles.end()) {
+    if (!failed->hasExpired(titleRetryDelay)) {
+      return;
+    }
+    failedTitles.erase(failed);
   }
 
   QUrl jsonUrl("https://www.netflix.com/title/" + nid);
@@ -313,58 +109,114 @@ QString NetflixMprisInterface::getArtUrl(const QString &nid) {
   titleInfoRequest.setRawHeader("Accept", "application/json");
   titleInfoRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute,
                                 QVariant(true));
+  titleInfoRequest.setPriority(priority);
 
-  // Here we assume that nobody but `metadataTimerFired` calls us.
-  // Since the timer ticks every second, it's unlikely that we will make
-  // duplicate requests. Otherwise we would need locks.
-  titleInfoFetching = true;
-  prevArtUrl = QString();
-  prevTitleId = nid;
+  // The page is scanned as it arrives and the download stops as soon as the
+  // art URL has been seen.
+  QNetworkReply *reply = networkManager.get(titleInfoRequest);
+  connect(reply, SIGNAL(readyRead()), this, SLOT(titleInfoReadyRead()));
 
-  networkManager.get(titleInfoRequest);
+  TitleInfoFetch &fetch = titleInfoFetches[reply];
+  fetch.nid = nid;
+  fetch.title = title;
+  fetch.priority = priority;
+}
 
-  // The request's under way. Hopefully, next time around the response will have
-  // arrived.
-  return QString();
+void NetflixMprisInterface::prefetchArt(const QString &url) {
+  QNetworkRequest artRequest((QUrl(url)));
+  artRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                          QNetworkRequest::PreferCache);
+  artRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute,
+                          QVariant(true));
+  artRequest.setPriority(QNetworkRequest::LowPriority);
+  networkManager.get(artRequest);
+}
+
+void NetflixMprisInterface::titleInfoReadyRead() {
+  auto reply = qobject_cast<QNetworkReply *>(sender());
+  bool found = false;
+
+  {
+    std::lock_guard<std::mutex> l(mtx_titleInfo);
+    auto it = titleInfoFetches.find(reply);
+    if (it == titleInfoFetches.end() || it->extractor.found()) {
+      return;
+    }
+
+    found = it->extractor.feed(reply->readAll());
+    if (found) {
+      window()->artCache()->insert(it->nid, it->extractor.artUrl(), it->title);
+      if (it->priority == QNetworkRequest::LowPriority) {
+        prefetchArt(it->extractor.artUrl());
+        prefetchedNid = it->nid;
+      }
+    }
+  }
+
+  if (found) {
+    // Nothing else on the page is needed. Aborting emits `finished`, which
+    // takes the lock again.
+    reply->abort();
+  }
 }
 
 void NetflixMprisInterface::networkManagerFinished(QNetworkReply *reply) {
-  if (!reply->error()) {
-    QString html = reply->readAll();
-    QRegExp rx("\"image\": *\"([^\"]*)\"");
-    if (rx.indexIn(html) != -1) {
-      prevArtUrl = rx.cap(1);
-    } else {
-      qDebug()
-          << "Could not find art URL in title info response. Check the regex.";
+  std::lock_guard<std::mutex> l(mtx_titleInfo);
+
+  auto it = titleInfoFetches.find(reply);
+  if (it == titleInfoFetches.end()) {
+    // An image fetched by `prefetchArt`, it is in the disk cache now.
+    if (reply->error()) {
+      qDebug() << "Art prefetch failed with error:" << reply->errorString();
     }
-  } else {
-    qDebug() << "Title info request failed with error:" << reply->errorString();
+    reply->deleteLater();
+    return;
   }
 
-  {
-    std::lock_guard<std::mutex> l(mtx_titleInfo);
-    titleInfoFetching = false;
+  TitleInfoFetch fetch = *it;
+  titleInfoFetches.erase(it);
+  if (fetch.extractor.found()) {
+    // Aborted on purpose by `titleInfoReadyRead`.
+  } else if (!reply->error()) {
+    qDebug()
+        << "Could not find art URL in title info response. Check the extractor.";
+    failedTitles[fetch.nid].start();
+  } else {
+    qDebug() << "Title info request failed with error:" << reply->errorString();
+    failedTitles[fetch.nid].start();
   }
 
   reply->deleteLater();
 }
 
 void NetflixMprisInterface::goNextTimerFired() {
-  QString code = ("(function () {"
-                  "var goNext = "
-                  "document.querySelector('button.touchable.PlayerControls--"
-                  "control-element.nfp-button-control.default-control-button."
-                  "button-nfplayerNextEpisode');"
-                  "if (!goNext) return false;"
-                  "else return true;"
-                  "})()");
-  webView()->page()->runJavaScript(code, [this](const QVariant &result) {
-    QString resultString = result.toString();
-    if (resultString == "false") {
-      workWithPlayer([](MprisPlayer &p) { p.setCanGoNext(false); });
-    } else {
-      workWithPlayer([](MprisPlayer &p) { p.setCanGoNext(true); });
-    }
-  });
+  query(
+      QStringLiteral("nextEpisode"),
+      ControllerScript<ControllerCall::NextEpisode>::source(),
+      [this](const QVariant &result) {
+        if (!isAttached()) {
+          return;
+        }
+        QVariantMap next = result.toMap();
+        bool canGoNext = next["canGoNext"].toBool();
+        publish(QStringLiteral("CanGoNext"), canGoNext,
+                [&](MprisPlayer &p) { p.setCanGoNext(canGoNext); });
+
+        // The next episode is coming up; get its art URL and image into the
+        // caches now so that the metadata is complete as soon as it starts.
+        QString nid = next["nid"].toString();
+        if (canGoNext && !nid.isEmpty() && nid != prefetchedNid) {
+          std::lock_guard<std::mutex> l(mtx_titleInfo);
+          ArtCacheEntry entry;
+          if (window()->artCache()->lookup(nid, &entry)) {
+            qDebug() << "Prefetching art for next episode" << nid;
+            prefetchArt(entry.artUrl);
+            prefetchedNid = nid;
+          } else {
+            qDebug() << "Prefetching title info for next episode" << nid;
+            fetchTitleInfo(nid, next["title"].toString(),
+                           QNetworkRequest::LowPriority);
+          }
+        }
+      });
 }
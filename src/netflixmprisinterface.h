@@ -4,9 +4,14 @@
 #include <mutex>
 #include <functional>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
 #include <QTimer>
 
 #include "mprisinterface.h"
+#include "titleinfoextractor.h"
 
 class MainWindow;
 
@@ -14,50 +19,49 @@ class NetflixMprisInterface : public MprisInterface {
   Q_OBJECT
 
 public:
-  explicit NetflixMprisInterface(QWidget *parent = nullptr);
+  explicit NetflixMprisInterface(const Provider &provider,
+                                 QWidget *parent = nullptr);
 
-  virtual void setup(MainWindow *window) override;
+  void setup(MainWindow *window, MprisPlayerHost *host) override;
+  void attach() override;
+  void detach() override;
 
-  void updatePlayerFullScreen();
+protected:
+  QString artUrl(const QString &nid, const QVariantMap &snapshot) override;
 
 private slots:
   // slots for handlers of hotkeys
-  void playVideo();
-  void pauseVideo();
-  void togglePlayPause();
   void goNextEpisode();
-  void setVideoVolume(double volume);
-  void setFullScreen(bool fullscreen);
-  void setPosition (QDBusObjectPath trackId,qlonglong pos);
-  void setSeek (qlonglong seekPos);
-  void playerStateTimerFired();
-  void playerPositionTimerFired();
-  void metadataTimerFired();
-  void volumeTimerFired();
   void goNextTimerFired();
 
+  void titleInfoReadyRead();
   void networkManagerFinished(QNetworkReply *reply);
 
 private:
-  QTimer playerStateTimer;
-  QTimer playerPositionTimer;
-  QTimer metadataTimer;
-  QTimer volumeTimer;
   QTimer goNextTimer;
   QNetworkAccessManager networkManager;
-  QString prevTitleId;
-  QString prevArtUrl;
-  std::mutex mtx_titleInfo;
-  bool titleInfoFetching;
-
-  QString getArtUrl(const QString& nid);
+  struct TitleInfoFetch {
+    QString nid;
+    QString title;
+    QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority;
+    TitleInfoExtractor extractor;
+  };
 
-  void getVideoState(std::function<void(Mpris::PlaybackStatus)> callback);
-  void getVideoPosition(std::function<void(qlonglong)> callback);
-  void getMetadata(std::function<void(qlonglong, const QString&, const QString&)> callback);
-  void getVolume(std::function<void(double)> callback);
-  void canGoNext(std::function<void(bool)>callback);
+  QHash<QNetworkReply *, TitleInfoFetch> titleInfoFetches;
+  // Title ids whose page could not be fetched or had no art URL, with the
+  // time of the failure. They are not asked for again until a while later.
+  QHash<QString, QElapsedTimer> failedTitles;
+  // The next episode whose art has been prefetched.
+  QString prefetchedNid;
+  std::mutex mtx_titleInfo;
 
+  QString getArtUrl(const QString& nid, const QString& title);
+  // Requests the title page of `nid` unless it is cached or already under
+  // way. Callers must hold `mtx_titleInfo`.
+  void fetchTitleInfo(const QString &nid, const QString &title,
+                      QNetworkRequest::Priority priority);
+  // Downloads the image at `url` into the disk cache ahead of its use.
+  void prefetchArt(const QString &url);
 };
 
 #endif // NETFLIXMPRISINTERFACE_H
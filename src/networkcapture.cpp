@@ -0,0 +1,200 @@
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QWebEngineUrlRequestInfo>
+
+#include "networkcapture.h"
+
+namespace {
+
+QString resourceTypeName(QWebEngineUrlRequestInfo::ResourceType type) {
+  switch (type) {
+  case QWebEngineUrlRequestInfo::ResourceTypeMainFrame:
+    return "document";
+  case QWebEngineUrlRequestInfo::ResourceTypeSubFrame:
+    return "subdocument";
+  case QWebEngineUrlRequestInfo::ResourceTypeStylesheet:
+    return "stylesheet";
+  case QWebEngineUrlRequestInfo::ResourceTypeScript:
+    return "script";
+  case QWebEngineUrlRequestInfo::ResourceTypeImage:
+    return "image";
+  case QWebEngineUrlRequestInfo::ResourceTypeFontResource:
+    return "font";
+  case QWebEngineUrlRequestInfo::ResourceTypeMedia:
+    return "media";
+  case QWebEngineUrlRequestInfo::ResourceTypeWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeSharedWorker:
+  case QWebEngineUrlRequestInfo::ResourceTypeServiceWorker:
+    return "worker";
+  case QWebEngineUrlRequestInfo::ResourceTypePrefetch:
+    return "prefetch";
+  case QWebEngineUrlRequestInfo::ResourceTypeFavicon:
+    return "favicon";
+  case QWebEngineUrlRequestInfo::ResourceTypeXhr:
+    return "xhr";
+  case QWebEngineUrlRequestInfo::ResourceTypePing:
+    return "ping";
+  case QWebEngineUrlRequestInfo::ResourceTypeCspReport:
+    return "csp_report";
+  case QWebEngineUrlRequestInfo::ResourceTypePluginResource:
+    return "plugin";
+  default:
+    return "other";
+  }
+}
+
+QString navigationTypeName(QWebEngineUrlRequestInfo::NavigationType type) {
+  switch (type) {
+  case QWebEngineUrlRequestInfo::NavigationTypeLink:
+    return "link";
+  case QWebEngineUrlRequestInfo::NavigationTypeTyped:
+    return "typed";
+  case QWebEngineUrlRequestInfo::NavigationTypeFormSubmitted:
+    return "form";
+  case QWebEngineUrlRequestInfo::NavigationTypeBackForward:
+    return "back_forward";
+  case QWebEngineUrlRequestInfo::NavigationTypeReload:
+    return "reload";
+  default:
+    return "other";
+  }
+}
+
+QString isoTime(const QDateTime &start, qint64 offset) {
+  return start.addMSecs(offset).toString(Qt::ISODateWithMs);
+}
+
+} // namespace
+
+NetworkCapture::NetworkCapture(const QString &fileName,
+                               const QElapsedTimer &origin, QObject *parent)
+    : QObject(parent), m_fileName(fileName), m_clock(origin) {
+  m_startedAt = QDateTime::currentDateTimeUtc().addMSecs(-origin.elapsed());
+}
+
+void NetworkCapture::recordRequest(const QWebEngineUrlRequestInfo &info,
+                                   const QString &action,
+                                   const QString &rule) {
+  Request request;
+  request.offset = m_clock.elapsed();
+  request.method = QString::fromLatin1(info.requestMethod());
+  request.url = info.requestUrl();
+  request.resourceType = resourceTypeName(info.resourceType());
+  request.navigationType = navigationTypeName(info.navigationType());
+  request.firstPartyUrl = info.firstPartyUrl();
+  request.action = action;
+  request.rule = rule;
+
+  std::lock_guard<std::mutex> l(m_mutex);
+  m_requests.append(request);
+}
+
+void NetworkCapture::recordEvent(const QString &name, const QString &detail) {
+  std::lock_guard<std::mutex> l(m_mutex);
+  m_events.append({m_clock.elapsed(), name, detail});
+}
+
+void NetworkCapture::loadStarted() { recordEvent("loadStarted"); }
+
+void NetworkCapture::loadFinished(bool ok) {
+  recordEvent("loadFinished", ok ? "ok" : "failed");
+}
+
+void NetworkCapture::videoStateChanged(const QString &type) {
+  // Everything before the first frame plays is the critical path.
+  if (type == "playing" && !m_seenPlaying) {
+    m_seenPlaying = true;
+    recordEvent("firstPlaying");
+  }
+}
+
+void NetworkCapture::save() const {
+  std::lock_guard<std::mutex> l(m_mutex);
+
+  QJsonArray events;
+  qint64 onLoad = -1;
+  for (const auto &event : m_events) {
+    QJsonObject object;
+    object["name"] = event.name;
+    object["time"] = static_cast<double>(event.offset);
+    if (!event.detail.isEmpty()) {
+      object["detail"] = event.detail;
+    }
+    events.append(object);
+    if (onLoad < 0 && event.name == "loadFinished") {
+      onLoad = event.offset;
+    }
+  }
+
+  QJsonObject pageTimings;
+  pageTimings["onContentLoad"] = -1;
+  pageTimings["onLoad"] = static_cast<double>(onLoad);
+
+  QJsonObject page;
+  page["id"] = "session";
+  page["title"] = "qtwebflix";
+  page["startedDateTime"] = m_startedAt.toString(Qt::ISODateWithMs);
+  page["pageTimings"] = pageTimings;
+  page["_events"] = events;
+
+  // The interceptor only sees requests, so the response side stays empty.
+  QJsonArray entries;
+  for (const auto &request : m_requests) {
+    QJsonObject req;
+    req["method"] = request.method;
+    req["url"] = request.url.toString();
+    req["httpVersion"] = "";
+    req["headers"] = QJsonArray();
+    req["queryString"] = QJsonArray();
+    req["cookies"] = QJsonArray();
+    req["headersSize"] = -1;
+    req["bodySize"] = -1;
+
+    QJsonObject timings;
+    timings["send"] = -1;
+    timings["wait"] = -1;
+    timings["receive"] = -1;
+
+    QJsonObject entry;
+    entry["pageref"] = "session";
+    entry["startedDateTime"] = isoTime(m_startedAt, request.offset);
+    entry["time"] = -1;
+    entry["request"] = req;
+    entry["response"] = QJsonObject();
+    entry["cache"] = QJsonObject();
+    entry["timings"] = timings;
+    entry["_offset"] = static_cast<double>(request.offset);
+    entry["_resourceType"] = request.resourceType;
+    entry["_navigationType"] = request.navigationType;
+    entry["_firstPartyUrl"] = request.firstPartyUrl.toString();
+    entry["_action"] = request.action;
+    if (!request.rule.isEmpty()) {
+      entry["_rule"] = request.rule;
+    }
+    entries.append(entry);
+  }
+
+  QJsonObject creator;
+  creator["name"] = "qtwebflix";
+  creator["version"] = QString(GIT_VERSION);
+
+  QJsonObject log;
+  log["version"] = "1.2";
+  log["creator"] = creator;
+  log["pages"] = QJsonArray{page};
+  log["entries"] = entries;
+
+  QSaveFile file(m_fileName);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "Could not write network capture" << m_fileName;
+    return;
+  }
+  file.write(QJsonDocument(QJsonObject{{"log", log}}).toJson());
+  file.commit();
+
+  qDebug() << "Wrote" << m_requests.size() << "captured requests to"
+           << m_fileName;
+}
@@ -0,0 +1,68 @@
+#ifndef NETWORKCAPTURE_H
+#define NETWORKCAPTURE_H
+
+#include <mutex>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+
+class QWebEngineUrlRequestInfo;
+
+// Opt-in recording of every request the profile makes, together with page
+// load milestones and the first `playing` event, written as HAR-like JSON.
+// Times are milliseconds since `origin`, the start of the main window's
+// construction.
+class NetworkCapture : public QObject {
+  Q_OBJECT
+
+public:
+  // `origin` is the clock all recorded times are relative to.
+  NetworkCapture(const QString &fileName, const QElapsedTimer &origin,
+                 QObject *parent = nullptr);
+
+  // Called from the interceptor, on the IO thread. `action` and `rule`
+  // describe what the interceptor did with the request.
+  void recordRequest(const QWebEngineUrlRequestInfo &info,
+                     const QString &action, const QString &rule);
+
+  void save() const;
+
+public slots:
+  void recordEvent(const QString &name, const QString &detail = QString());
+  void loadStarted();
+  void loadFinished(bool ok);
+  void videoStateChanged(const QString &type);
+
+private:
+  struct Request {
+    qint64 offset;
+    QString method;
+    QUrl url;
+    QString resourceType;
+    QString navigationType;
+    QUrl firstPartyUrl;
+    QString action;
+    QString rule;
+  };
+
+  struct Event {
+    qint64 offset;
+    QString name;
+    QString detail;
+  };
+
+  QString m_fileName;
+  QDateTime m_startedAt;
+  QElapsedTimer m_clock;
+  bool m_seenPlaying = false;
+
+  mutable std::mutex m_mutex;
+  QVector<Request> m_requests;
+  QVector<Event> m_events;
+};
+
+#endif // NETWORKCAPTURE_H
@@ -0,0 +1,130 @@
+#include <QDebug>
+#include <QPointer>
+#include <QWebEnginePage>
+
+#include "pagequeries.h"
+
+namespace {
+
+// Well above a round trip to a responsive renderer, which takes a few ms.
+const int defaultTimeout = 3000;
+
+} // namespace
+
+PageQueries::PageQueries(QObject *parent)
+    : QObject(parent), m_timeout(defaultTimeout) {
+  connect(&m_timeoutTimer, &QTimer::timeout, this,
+          &PageQueries::checkTimeouts);
+}
+
+void PageQueries::setTimeout(int timeout) { m_timeout = timeout; }
+
+bool PageQueries::run(QWebEnginePage *page, quint32 world, const QString &kind,
+                      const QString &script, Callback callback) {
+  Statistics &statistics = m_statistics[kind];
+  Query &query = m_queries[kind];
+  if (query.inFlight) {
+    ++statistics.skipped;
+    return false;
+  }
+  ++statistics.run;
+
+  query.inFlight = true;
+  query.id = m_nextId++;
+  query.started.start();
+  query.callback = std::move(callback);
+  m_maxDepth = qMax(m_maxDepth, ++m_depth);
+  m_ranSinceCheck = true;
+
+  // The page may call back after this object is gone. The id alone finds
+  // the query again, so the kind is not copied into every callback.
+  QPointer<PageQueries> self(this);
+  quint64 id = query.id;
+  page->runJavaScript(script, world, [self, id](const QVariant &result) {
+    if (self) {
+      self->finished(id, result);
+    }
+  });
+  if (!m_timeoutTimer.isActive()) {
+    // Checked twice per timeout, so a query is given up after 1 to 1.5
+    // times the timeout. Left running while queries keep coming, as
+    // registering a timer allocates.
+    m_timeoutTimer.start(m_timeout / 2);
+  }
+  return true;
+}
+
+void PageQueries::cancel() {
+  for (auto &query : m_queries) {
+    if (query.second.inFlight) {
+      query.second.inFlight = false;
+      query.second.callback = nullptr;
+      ++m_statistics[query.first].cancelled;
+    }
+  }
+  m_depth = 0;
+  m_timeoutTimer.stop();
+}
+
+int PageQueries::depth() const { return m_depth; }
+
+void PageQueries::finished(quint64 id, const QVariant &result) {
+  // One entry per kind, so a scan is as cheap as a lookup by kind.
+  auto it = m_queries.begin();
+  while (it != m_queries.end() &&
+         !(it->second.inFlight && it->second.id == id)) {
+    ++it;
+  }
+  if (it == m_queries.end()) {
+    // Given up or cancelled.
+    return;
+  }
+  Query &query = it->second;
+
+  Statistics &statistics = m_statistics[it->first];
+  qint64 latency = query.started.nsecsElapsed() / 1000;
+  ++statistics.completed;
+  statistics.totalLatency += latency;
+  statistics.maxLatency = qMax(statistics.maxLatency, latency);
+
+  // Done before the callback, which may well start the next query.
+  query.inFlight = false;
+  --m_depth;
+  Callback callback = std::move(query.callback);
+  query.callback = nullptr;
+  callback(result);
+}
+
+void PageQueries::checkTimeouts() {
+  for (auto &query : m_queries) {
+    if (query.second.inFlight &&
+        query.second.started.hasExpired(m_timeout)) {
+      qDebug() << "Page query" << query.first << "timed out after"
+               << query.second.started.elapsed() << "ms";
+      query.second.inFlight = false;
+      query.second.callback = nullptr;
+      ++m_statistics[query.first].timedOut;
+      --m_depth;
+    }
+  }
+  if (m_depth == 0 && !m_ranSinceCheck) {
+    m_timeoutTimer.stop();
+  }
+  m_ranSinceCheck = false;
+}
+
+void PageQueries::logStatistics() const {
+  qDebug() << "Page queries:" << depth() << "in flight, at most" << m_maxDepth;
+  for (const auto &entry : m_statistics) {
+    const Statistics &statistics = entry.second;
+    qDebug() << "  " << entry.first << ":" << statistics.run << "run,"
+             << statistics.completed << "completed," << statistics.skipped
+             << "skipped," << statistics.timedOut << "timed out,"
+             << statistics.cancelled << "cancelled, latency mean"
+             << (statistics.completed
+                     ? statistics.totalLatency / 1000 /
+                           static_cast<qint64>(statistics.completed)
+                     : 0)
+             << "ms, max" << statistics.maxLatency / 1000 << "ms";
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef PAGEQUERIES_H
+#define PAGEQUERIES_H
+
+#include <functional>
+#include <map>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+class QWebEnginePage;
+
+// Runs the scripts MprisInterface evaluates for a result, such as the
+// snapshot polled every tick, with at most one of each kind in flight.
+//
+// While the renderer is busy (loading, collecting garbage) results come back
+// late. Without backpressure the ticks in between would queue up queries that
+// then all return at once, each one updating the player. Instead, a query
+// whose kind is still in flight is skipped, and one that does not return
+// within the timeout is given up so that the next can go out. Results of
+// queries given up, cancelled or outliving this object are dropped.
+class PageQueries : public QObject {
+  Q_OBJECT
+
+public:
+  typedef std::function<void(const QVariant &)> Callback;
+
+  explicit PageQueries(QObject *parent = nullptr);
+
+  // Time in ms after which a query is given up.
+  void setTimeout(int timeout);
+
+  // Evaluates `script` in `world` of `page` and hands the result to
+  // `callback`. Returns false if a query of `kind` is still in flight, in
+  // which case nothing is run.
+  bool run(QWebEnginePage *page, quint32 world, const QString &kind,
+           const QString &script, Callback callback);
+  // Drops all queries in flight, e.g. when the page they went to is no
+  // longer the one being followed.
+  void cancel();
+
+  // Queries currently in flight.
+  int depth() const;
+  void logStatistics() const;
+
+private:
+  // Kept per kind once created, so that a query does not allocate one.
+  struct Query {
+    bool inFlight = false;
+    quint64 id = 0;
+    QElapsedTimer started;
+    Callback callback;
+  };
+
+  struct Statistics {
+    quint64 run = 0;
+    quint64 completed = 0;
+    quint64 skipped = 0;
+    quint64 timedOut = 0;
+    quint64 cancelled = 0;
+    // Of completed queries, in microseconds.
+    qint64 totalLatency = 0;
+    qint64 maxLatency = 0;
+  };
+
+  void finished(quint64 id, const QVariant &result);
+  void checkTimeouts();
+
+  int m_timeout;
+  // Runs while queries are in flight or were run since its last timeout,
+  // one timer rather than one per query.
+  QTimer m_timeoutTimer;
+  bool m_ranSinceCheck = false;
+  quint64 m_nextId = 1;
+  std::map<QString, Query> m_queries;
+  std::map<QString, Statistics> m_statistics;
+  int m_depth = 0;
+  int m_maxDepth = 0;
+};
+
+#endif // PAGEQUERIES_H
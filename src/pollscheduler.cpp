@@ -0,0 +1,126 @@
+#include <QDebug>
+
+#include "pollscheduler.h"
+
+namespace {
+
+// How long a seek or position request keeps the poll tight.
+const int watchDuration = 10000;
+const int watchedInterval = 250;
+const int pausedInterval = 3000;
+const int stoppedInterval = 5000;
+// The hidden interval is the base interval times this factor.
+const int hiddenFactor = 4;
+
+} // namespace
+
+PollScheduler::PollScheduler(QObject *parent)
+    : QObject(parent), m_baseInterval(1000),
+      m_status(Mpris::InvalidPlaybackStatus), m_visible(true), m_wakeups(0),
+      m_periodWakeups(0) {
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(timerFired()));
+
+  m_watchTimer.setSingleShot(true);
+  connect(&m_watchTimer, SIGNAL(timeout()), this, SLOT(reschedule()));
+
+  m_period.start();
+}
+
+void PollScheduler::setBaseInterval(int interval) {
+  m_baseInterval = interval;
+  reschedule();
+}
+
+void PollScheduler::setPlaybackStatus(Mpris::PlaybackStatus status) {
+  if (m_status == status) {
+    return;
+  }
+  m_status = status;
+  reschedule();
+}
+
+void PollScheduler::setWindowVisible(bool visible) {
+  if (m_visible == visible) {
+    return;
+  }
+  m_visible = visible;
+  reschedule();
+}
+
+void PollScheduler::positionWatched() {
+  bool wasWatched = m_watchTimer.isActive();
+  m_watchTimer.start(watchDuration);
+  if (!wasWatched) {
+    reschedule();
+  }
+}
+
+void PollScheduler::stop() {
+  m_watchTimer.stop();
+  m_timer.stop();
+  m_status = Mpris::InvalidPlaybackStatus;
+  m_reason = "stopped";
+  qDebug() << "Poll scheduler: stopped";
+}
+
+int PollScheduler::interval() const {
+  return m_timer.isActive() ? m_timer.interval() : 0;
+}
+
+qint64 PollScheduler::wakeups() const { return m_wakeups; }
+
+void PollScheduler::timerFired() {
+  ++m_wakeups;
+  ++m_periodWakeups;
+
+  if (m_period.elapsed() >= 60000) {
+    qDebug() << "Poll scheduler:" << m_periodWakeups << "wakeups in the last"
+             << m_period.elapsed() / 1000 << "s," << m_reason;
+    m_periodWakeups = 0;
+    m_period.restart();
+  }
+
+  emit tick();
+}
+
+void PollScheduler::reschedule() {
+  int interval;
+  QString reason;
+
+  bool playing = m_status == Mpris::Playing;
+  bool idle = m_status == Mpris::Paused || m_status == Mpris::Stopped;
+
+  if (!m_visible && idle) {
+    interval = 0;
+    reason = "hidden and idle";
+  } else if (playing && m_watchTimer.isActive()) {
+    interval = watchedInterval;
+    reason = "position watched";
+  } else if (!m_visible) {
+    interval = m_baseInterval * hiddenFactor;
+    reason = "hidden";
+  } else if (m_status == Mpris::Paused) {
+    interval = pausedInterval;
+    reason = "paused";
+  } else if (m_status == Mpris::Stopped) {
+    interval = stoppedInterval;
+    reason = "no video";
+  } else {
+    interval = m_baseInterval;
+    reason = playing ? "playing" : "state unknown";
+  }
+
+  if (interval == this->interval()) {
+    m_reason = reason;
+    return;
+  }
+
+  qDebug() << "Poll scheduler:" << reason << "- interval" << interval << "ms";
+  m_reason = reason;
+
+  if (interval > 0) {
+    m_timer.start(interval);
+  } else {
+    m_timer.stop();
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <Mpris>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Decides how often MprisInterface samples the page. Playback changes are
+// pushed by the video bridge, so the poll only has to be fast while something
+// is actually playing and a client is paying attention to it.
+class PollScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PollScheduler(QObject *parent = nullptr);
+
+  // Interval used while a video is playing in a visible window.
+  void setBaseInterval(int interval);
+  void setPlaybackStatus(Mpris::PlaybackStatus status);
+  void setWindowVisible(bool visible);
+  // A client just asked for a position change, poll tightly for a while.
+  void positionWatched();
+  // Stops polling until the next setBaseInterval().
+  void stop();
+
+  // Current interval in ms, 0 while polling is stopped.
+  int interval() const;
+  // Number of ticks since construction.
+  qint64 wakeups() const;
+
+signals:
+  void tick();
+
+private slots:
+  void timerFired();
+  void reschedule();
+
+private:
+  QTimer m_timer;
+  QTimer m_watchTimer;
+  int m_baseInterval;
+  Mpris::PlaybackStatus m_status;
+  bool m_visible;
+  QString m_reason;
+
+  qint64 m_wakeups;
+  qint64 m_periodWakeups;
+  QElapsedTimer m_period;
+};
+
+#endif // POLLSCHEDULER_H
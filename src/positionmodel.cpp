@@ -0,0 +1,39 @@
+#include "positionmodel.h"
+
+PositionModel::PositionModel()
+    : m_anchorPosition(-1), m_rate(1), m_playing(false) {}
+
+void PositionModel::anchor(qlonglong position, double rate, bool playing) {
+  m_anchorPosition = position;
+  m_rate = rate;
+  m_playing = playing;
+  m_anchorTime.start();
+}
+
+void PositionModel::invalidate() {
+  m_anchorPosition = -1;
+  m_anchorTime.invalidate();
+}
+
+bool PositionModel::isValid() const {
+  return m_anchorPosition >= 0 && m_anchorTime.isValid();
+}
+
+bool PositionModel::playing() const { return m_playing; }
+
+double PositionModel::rate() const { return m_rate; }
+
+qlonglong PositionModel::position() const {
+  if (!isValid()) {
+    return -1;
+  }
+  if (!m_playing) {
+    return m_anchorPosition;
+  }
+  return m_anchorPosition +
+         static_cast<qlonglong>(m_anchorTime.nsecsElapsed() / 1000 * m_rate);
+}
+
+qlonglong PositionModel::drift(qlonglong observed) const {
+  return observed - position();
+}
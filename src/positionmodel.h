@@ -0,0 +1,32 @@
+#ifndef POSITIONMODEL_H
+#define POSITIONMODEL_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+// Extrapolates the playback position from the last observed (time,
+// position, rate) anchor, the same way MPRIS clients do. Positions are in
+// microseconds, -1 meaning unknown.
+class PositionModel {
+public:
+  PositionModel();
+
+  void anchor(qlonglong position, double rate, bool playing);
+  void invalidate();
+
+  bool isValid() const;
+  bool playing() const;
+  double rate() const;
+  qlonglong position() const;
+
+  // How far `observed` is ahead of the extrapolated position.
+  qlonglong drift(qlonglong observed) const;
+
+private:
+  QElapsedTimer m_anchorTime;
+  qlonglong m_anchorPosition;
+  double m_rate;
+  bool m_playing;
+};
+
+#endif // POSITIONMODEL_H
@@ -0,0 +1,129 @@
+#include <algorithm>
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "providerregistry.h"
+
+namespace {
+
+Provider fromJson(const QJsonObject &object) {
+  Provider provider;
+  provider.name = object["name"].toString();
+  for (const auto &host : object["hosts"].toArray()) {
+    provider.hosts.append(host.toString().toLower());
+  }
+  provider.interface = object["interface"].toString(provider.interface);
+  provider.controller = object["controller"].toString(provider.controller);
+  if (object.contains("assets")) {
+    provider.assets.clear();
+    for (const auto &asset : object["assets"].toArray()) {
+      provider.assets.append(asset.toString());
+    }
+  }
+  provider.selectors = object["selectors"].toObject().toVariantMap();
+  provider.mainWorld = object["world"].toString() == "main";
+  provider.pollInterval = object["pollInterval"].toInt(provider.pollInterval);
+  provider.userAgent = object["userAgent"].toString();
+  provider.positionOffset = object["positionOffset"].toDouble();
+  provider.trackIdPrefix =
+      object["trackIdPrefix"].toString(provider.trackIdPrefix);
+  provider.identity = object["identity"].toString(provider.identity);
+  return provider;
+}
+
+} // namespace
+
+ProviderRegistry::ProviderRegistry() {
+  load(":/providers/providers.json");
+}
+
+bool ProviderRegistry::load(const QString &fileName) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QJsonParseError error;
+  QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+  if (document.isNull()) {
+    qDebug() << "Could not parse" << fileName << ":" << error.errorString();
+    return false;
+  }
+
+  for (const auto &value : document.object()["providers"].toArray()) {
+    Provider provider = fromJson(value.toObject());
+    if (provider.name.isEmpty()) {
+      continue;
+    }
+
+    auto it = std::find_if(
+        m_providers.begin(), m_providers.end(),
+        [&](const Provider &other) { return other.name == provider.name; });
+    if (it != m_providers.end()) {
+      *it = provider;
+    } else {
+      m_providers.append(provider);
+    }
+  }
+  reindex();
+
+  qDebug() << "Loaded providers from" << fileName << "-" << m_providers.size()
+           << "defined";
+  return true;
+}
+
+void ProviderRegistry::reindex() {
+  m_byHost.clear();
+  m_default = -1;
+  for (int i = 0; i < m_providers.size(); ++i) {
+    for (const auto &host : m_providers[i].hosts) {
+      m_byHost[qHash(host)].append(i);
+    }
+    if (m_providers[i].name == "default") {
+      m_default = i;
+    }
+  }
+
+  // Pages on unknown hosts still need a controller.
+  if (m_default < 0) {
+    Provider provider;
+    provider.name = "default";
+    m_providers.append(provider);
+    m_default = m_providers.size() - 1;
+  }
+}
+
+const Provider &ProviderRegistry::lookup(const QString &host) const {
+  // QUrl keeps hosts lower-cased. The longest suffix is tried first, so
+  // subdomains may have a provider of their own.
+  int start = 0;
+  while (start >= 0) {
+    QStringRef suffix = host.midRef(start);
+    auto it = m_byHost.constFind(qHash(suffix));
+    if (it != m_byHost.constEnd()) {
+      for (int index : it.value()) {
+        for (const auto &candidate : m_providers[index].hosts) {
+          if (candidate == suffix) {
+            return m_providers[index];
+          }
+        }
+      }
+    }
+
+    start = host.indexOf('.', start);
+    if (start >= 0) {
+      ++start;
+    }
+  }
+  return m_providers[m_default];
+}
+
+const Provider &ProviderRegistry::defaultProvider() const {
+  return m_providers[m_default];
+}
+
+int ProviderRegistry::size() const { return m_providers.size(); }
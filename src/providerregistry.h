@@ -0,0 +1,63 @@
+#ifndef PROVIDERREGISTRY_H
+#define PROVIDERREGISTRY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// How qtwebflix integrates with one streaming service.
+struct Provider {
+  QString name;
+  // The provider handles these hosts and all of their subdomains.
+  QStringList hosts;
+  // MPRIS interface implementation, "default" or "netflix".
+  QString interface = QStringLiteral("default");
+  // Script installing the `__qwf` controller, a resource or file path.
+  QString controller = QStringLiteral(":/scripts/selectors.js");
+  // Bundled scripts the controller builds on, see ScriptAssets.
+  QStringList assets{QStringLiteral("controller")};
+  // Handed to the controller as `__qwfProvider.selectors`.
+  QVariantMap selectors;
+  // Run the controller in the page's own world instead of an isolated one.
+  bool mainWorld = false;
+  // Poll interval while playing in a visible window, see PollScheduler.
+  int pollInterval = 500;
+  // Reported to the page through navigator.userAgent if set.
+  QString userAgent;
+  // Seconds added to the position reported by the page.
+  double positionOffset = 0;
+  QString trackIdPrefix = QStringLiteral("/com/video/title/");
+  // MPRIS Identity, the D-Bus service name is the same for all providers.
+  QString identity = QStringLiteral("QtWebFlix");
+};
+
+// Provider definitions indexed by host, read once at startup from the
+// bundled providers.json and an optional user file of the same format.
+// Lookups hash each dot-separated suffix of the host, so they cost
+// O(host length) however many providers are defined.
+class ProviderRegistry {
+public:
+  ProviderRegistry();
+
+  // Adds the providers defined in `fileName`, replacing those of the same
+  // name. Returns false if the file could not be read.
+  bool load(const QString &fileName);
+
+  // The provider for `host`, or the "default" one.
+  const Provider &lookup(const QString &host) const;
+  const Provider &defaultProvider() const;
+
+  int size() const;
+
+private:
+  void reindex();
+
+  QVector<Provider> m_providers;
+  // qHash of the host suffix -> indices into `m_providers`.
+  QHash<uint, QVector<int>> m_byHost;
+  int m_default = -1;
+};
+
+#endif // PROVIDERREGISTRY_H
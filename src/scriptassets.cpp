@@ -0,0 +1,82 @@
+#include <QDebug>
+#include <QFile>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+#include "scriptassets.h"
+
+namespace {
+
+struct AssetDefinition {
+  const char *name;
+  const char *path;
+  // Appended to the file, for libraries that need setting up.
+  const char *suffix;
+};
+
+const AssetDefinition definitions[] = {
+    // Only adds to `qt`, which in the bridge's world also holds the
+    // transport QWebChannel reaches the application through.
+    {"jquery", ":/jquery.min.js",
+     "\nwindow.qt = window.qt || {};\nqt.jQuery = jQuery.noConflict(true);"},
+    {"qwebchannel", ":/qtwebchannel/qwebchannel.js", nullptr},
+    {"videobridge", ":/scripts/videobridge.js", nullptr},
+    {"controller", ":/scripts/controller.js", nullptr},
+};
+
+} // namespace
+
+ScriptAssets::ScriptAssets(QObject *parent) : QObject(parent) {}
+
+QString ScriptAssets::install(QWebEngineScriptCollection &scripts,
+                              const QString &name, const QStringList &assets,
+                              quint32 world, const QString &prelude) {
+  QString source = prelude;
+  for (const auto &asset : assets) {
+    if (!append(asset, source)) {
+      return QString();
+    }
+    source.append('\n');
+  }
+
+  uninstall(scripts, name);
+
+  QWebEngineScript script;
+  script.setName(name);
+  script.setSourceCode(source);
+  script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+  script.setWorldId(world);
+  script.setRunsOnSubFrames(false);
+  scripts.insert(script);
+  return source;
+}
+
+void ScriptAssets::uninstall(QWebEngineScriptCollection &scripts,
+                             const QString &name) {
+  for (const auto &script : scripts.findScripts(name)) {
+    scripts.remove(script);
+  }
+}
+
+bool ScriptAssets::append(const QString &name, QString &source) {
+  QString path = name;
+  const char *suffix = nullptr;
+  for (const auto &definition : definitions) {
+    if (name == QLatin1String(definition.name)) {
+      path = QString::fromLatin1(definition.path);
+      suffix = definition.suffix;
+      break;
+    }
+  }
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qDebug() << "Could not load script asset" << path;
+    return false;
+  }
+  source.append(QString::fromUtf8(file.readAll()));
+  if (suffix) {
+    source.append(QLatin1String(suffix));
+  }
+  return true;
+}
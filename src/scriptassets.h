@@ -0,0 +1,36 @@
+#ifndef SCRIPTASSETS_H
+#define SCRIPTASSETS_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QWebEngineScriptCollection;
+
+// Bundled JavaScript, read from the resources only when a script that needs
+// it is installed. The text is not kept here: the installed script holds the
+// one copy there is, and it goes away with the script.
+//
+// Assets are named either by an alias ("jquery", "qwebchannel",
+// "videobridge", "controller") or by their resource path.
+class ScriptAssets : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ScriptAssets(QObject *parent = nullptr);
+
+  // Installs `assets`, concatenated after `prelude`, as a DocumentCreation
+  // script called `name` in `world`, replacing a script of that name
+  // installed earlier. Returns the source, or a null string if an asset
+  // could not be read.
+  QString install(QWebEngineScriptCollection &scripts, const QString &name,
+                  const QStringList &assets, quint32 world,
+                  const QString &prelude = QString());
+  void uninstall(QWebEngineScriptCollection &scripts, const QString &name);
+
+private:
+  // Appends the text of asset `name` to `source`.
+  bool append(const QString &name, QString &source);
+};
+
+#endif // SCRIPTASSETS_H
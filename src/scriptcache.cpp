@@ -0,0 +1,230 @@
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QWebEngineUrlRequestJob>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QWebEngineUrlScheme>
+#endif
+
+#include "scriptcache.h"
+
+const QByteArray ScriptCache::scheme = QByteArrayLiteral("qtwebflix");
+
+void ScriptCache::registerScheme() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+  // Secure, so that https pages may load it without mixed content warnings.
+  QWebEngineUrlScheme webflix(scheme);
+  webflix.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+  webflix.setFlags(QWebEngineUrlScheme::SecureScheme |
+                   QWebEngineUrlScheme::CorsEnabled |
+                   QWebEngineUrlScheme::ContentSecurityPolicyIgnored);
+  QWebEngineUrlScheme::registerScheme(webflix);
+#endif
+}
+
+ScriptCache::ScriptCache(int refreshHours, QObject *parent)
+    : QWebEngineUrlSchemeHandler(parent), m_refreshHours(refreshHours) {
+  m_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+          "/scripts";
+  connect(&m_network, SIGNAL(finished(QNetworkReply *)), this,
+          SLOT(downloadFinished(QNetworkReply *)));
+}
+
+void ScriptCache::load() {
+  QFile file(m_dir + "/index.json");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QJsonObject index = QJsonDocument::fromJson(file.readAll()).object();
+  for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+    QJsonObject object = it.value().toObject();
+    Entry &entry = m_entries[it.key()];
+    entry.source = QUrl(object["source"].toString());
+    entry.file = object["file"].toString();
+    entry.etag = object["etag"].toString().toUtf8();
+    entry.fetchedAt = QDateTime::fromMSecsSinceEpoch(
+        static_cast<qint64>(object["fetchedAt"].toDouble()));
+  }
+
+  qDebug() << "Loaded" << m_entries.size() << "cached scripts from" << m_dir;
+}
+
+void ScriptCache::save() {
+  QJsonObject index;
+  for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+    if (it->file.isEmpty()) {
+      continue;
+    }
+    QJsonObject object;
+    object["source"] = it->source.toString();
+    object["file"] = it->file;
+    object["etag"] = QString::fromUtf8(it->etag);
+    object["fetchedAt"] =
+        static_cast<double>(it->fetchedAt.toMSecsSinceEpoch());
+    index[it.key()] = object;
+  }
+
+  QDir().mkpath(m_dir);
+  QSaveFile file(m_dir + "/index.json");
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "Could not write script cache index in" << m_dir;
+    return;
+  }
+  file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+  file.commit();
+}
+
+QUrl ScriptCache::add(const QString &name, const QUrl &source) {
+  Entry &entry = m_entries[name];
+
+  // A different source is a different script, the cached one is unusable.
+  if (entry.source != source) {
+    if (!entry.file.isEmpty()) {
+      QFile::remove(m_dir + "/" + entry.file);
+    }
+    entry = Entry();
+    entry.source = source;
+  }
+
+  if (entry.file.isEmpty() || !readData(entry)) {
+    fetch(name, entry);
+  } else if (entry.fetchedAt.addSecs(m_refreshHours * 3600) <
+             QDateTime::currentDateTimeUtc()) {
+    qDebug() << "Refreshing cached script" << name << "in the background";
+    fetch(name, entry);
+  }
+
+  QUrl url;
+  url.setScheme(QString::fromLatin1(scheme));
+  url.setPath("script/" + name);
+  return url;
+}
+
+bool ScriptCache::readData(Entry &entry) {
+  QFile file(m_dir + "/" + entry.file);
+  if (!file.open(QIODevice::ReadOnly)) {
+    entry.file.clear();
+    return false;
+  }
+  entry.data = file.readAll();
+  return true;
+}
+
+void ScriptCache::fetch(const QString &name, Entry &entry) {
+  if (entry.download) {
+    return;
+  }
+
+  QNetworkRequest request(entry.source);
+  request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+  if (entry.data.isEmpty()) {
+    request.setPriority(QNetworkRequest::HighPriority);
+  } else {
+    // Something is already being served, this is only a refresh.
+    request.setPriority(QNetworkRequest::LowPriority);
+    if (!entry.etag.isEmpty()) {
+      request.setRawHeader("If-None-Match", entry.etag);
+    }
+  }
+
+  entry.download = m_network.get(request);
+  entry.download->setProperty("name", name);
+}
+
+void ScriptCache::downloadFinished(QNetworkReply *reply) {
+  reply->deleteLater();
+
+  QString name = reply->property("name").toString();
+  auto it = m_entries.find(name);
+  if (it == m_entries.end() || it->download != reply) {
+    return;
+  }
+  Entry &entry = it.value();
+  entry.download = nullptr;
+
+  int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if (reply->error() != QNetworkReply::NoError) {
+    qDebug() << "Could not fetch script" << name << ":" << reply->errorString();
+  } else if (status == 304) {
+    entry.fetchedAt = QDateTime::currentDateTimeUtc();
+    save();
+  } else {
+    QByteArray data = reply->readAll();
+    QString file =
+        name + "-" +
+        QString::fromLatin1(
+            QCryptographicHash::hash(data, QCryptographicHash::Sha1)
+                .toHex()
+                .left(12)) +
+        ".js";
+
+    QDir().mkpath(m_dir);
+    QSaveFile out(m_dir + "/" + file);
+    if (out.open(QIODevice::WriteOnly) && out.write(data) == data.size() &&
+        out.commit()) {
+      if (!entry.file.isEmpty() && entry.file != file) {
+        QFile::remove(m_dir + "/" + entry.file);
+      }
+      qDebug() << "Cached script" << name << "as" << file;
+      entry.file = file;
+    } else {
+      qDebug() << "Could not write cached script" << file;
+    }
+    entry.data = data;
+    entry.etag = reply->rawHeader("ETag");
+    entry.fetchedAt = QDateTime::currentDateTimeUtc();
+    save();
+  }
+
+  for (const auto &job : entry.waiting) {
+    if (!job) {
+      continue;
+    }
+    if (entry.data.isEmpty()) {
+      // Let the page try the source itself rather than fail the player.
+      job->redirect(entry.source);
+    } else {
+      requestStarted(job);
+    }
+  }
+  entry.waiting.clear();
+}
+
+void ScriptCache::requestStarted(QWebEngineUrlRequestJob *job) {
+  QString path = job->requestUrl().path();
+  if (!path.startsWith("script/")) {
+    job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+    return;
+  }
+
+  auto it = m_entries.find(path.mid(7));
+  if (it == m_entries.end()) {
+    job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+    return;
+  }
+
+  if (it->data.isEmpty()) {
+    if (it->download) {
+      // Answered from downloadFinished().
+      it->waiting.append(job);
+    } else {
+      job->redirect(it->source);
+    }
+    return;
+  }
+
+  // The buffer is deleted along with the job.
+  QBuffer *buffer = new QBuffer(job);
+  buffer->setData(it->data);
+  job->reply(QByteArrayLiteral("application/javascript"), buffer);
+}
@@ -0,0 +1,69 @@
+#ifndef SCRIPTCACHE_H
+#define SCRIPTCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+#include <QWebEngineUrlSchemeHandler>
+
+class QNetworkReply;
+class QWebEngineUrlRequestJob;
+
+// Local, versioned copies of the scripts interceptor rules redirect to,
+// served to the page as qtwebflix:script/<name>. Each script is downloaded
+// once, stored under its content hash and refreshed in the background, so
+// loading the player no longer waits on the upstream CDN.
+//
+// The source may be a file:// URL, which lets the whole path run offline
+// against a local fixture.
+class ScriptCache : public QWebEngineUrlSchemeHandler {
+  Q_OBJECT
+
+public:
+  static const QByteArray scheme;
+
+  // Registers the scheme, must be called before the QApplication is created.
+  static void registerScheme();
+
+  explicit ScriptCache(int refreshHours, QObject *parent = nullptr);
+
+  void load();
+
+  // Starts caching `source` under `name` and returns the local URL to
+  // redirect to instead.
+  QUrl add(const QString &name, const QUrl &source);
+
+  void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+private slots:
+  void downloadFinished(QNetworkReply *reply);
+
+private:
+  struct Entry {
+    QUrl source;
+    // `<name>-<content hash>.js`, empty until the first download finished.
+    QString file;
+    QByteArray etag;
+    QDateTime fetchedAt;
+    QByteArray data;
+    QNetworkReply *download = nullptr;
+    // Requests that arrived before the first download finished.
+    QList<QPointer<QWebEngineUrlRequestJob>> waiting;
+  };
+
+  void fetch(const QString &name, Entry &entry);
+  bool readData(Entry &entry);
+  void save();
+
+  QString m_dir;
+  int m_refreshHours;
+  QHash<QString, Entry> m_entries;
+  QNetworkAccessManager m_network;
+};
+
+#endif // SCRIPTCACHE_H
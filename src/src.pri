@@ -0,0 +1,90 @@
+# Everything but main(), shared by the application and the benchmarks.
+
+QT       += webenginewidgets webchannel core dbus
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+#Check  version of qt to enable hide scrollbars available in qt 5.10+
+equals(QT_MAJOR_VERSION, 5):!lessThan(QT_MINOR_VERSION, 10) {
+   DEFINES += HAS_SCROLLBAR
+} else {
+  message(Qt $$QT_VERSION ScrollBars not supported in this version.)
+}
+
+#Get current git tag and use for version number
+BASE_GIT_COMMAND = git --git-dir $$PWD/../.git --work-tree $$PWD
+GIT_VERSION = $$system($$BASE_GIT_COMMAND describe --always --tags)
+DEFINES += GIT_VERSION=\\\"$$GIT_VERSION\\\"
+
+
+SOURCES += $$PWD/mainwindow.cpp \
+           $$PWD/urlrequestinterceptor.cpp \
+           $$PWD/commandlineparser.cpp \
+           $$PWD/mprisinterface.cpp \
+           $$PWD/defaultmprisinterface.cpp \
+           $$PWD/netflixmprisinterface.cpp\
+           $$PWD/videobridge.cpp \
+           $$PWD/pollscheduler.cpp \
+           $$PWD/commandqueue.cpp \
+           $$PWD/pagequeries.cpp \
+           $$PWD/mprispropertycache.cpp \
+           $$PWD/positionmodel.cpp \
+           $$PWD/artcache.cpp \
+           $$PWD/titleinfoextractor.cpp \
+           $$PWD/urlrules.cpp \
+           $$PWD/scriptcache.cpp \
+           $$PWD/networkcapture.cpp \
+           $$PWD/tracer.cpp \
+           $$PWD/scriptassets.cpp \
+           $$PWD/providerregistry.cpp \
+           $$PWD/mprisplayerhost.cpp \
+           $$PWD/webtab.cpp \
+           $$PWD/memorymonitor.cpp
+HEADERS  += $$PWD/mainwindow.h \
+            $$PWD/urlrequestinterceptor.h \
+            $$PWD/commandlineparser.h \
+            $$PWD/mprisinterface.h \
+            $$PWD/defaultmprisinterface.h \
+            $$PWD/netflixmprisinterface.h\
+            $$PWD/videobridge.h \
+            $$PWD/pollscheduler.h \
+            $$PWD/commandqueue.h \
+            $$PWD/pagequeries.h \
+            $$PWD/controllerscripts.h \
+            $$PWD/mprispropertycache.h \
+            $$PWD/positionmodel.h \
+            $$PWD/artcache.h \
+            $$PWD/titleinfoextractor.h \
+            $$PWD/urlrules.h \
+            $$PWD/scriptcache.h \
+            $$PWD/networkcapture.h \
+            $$PWD/tracer.h \
+            $$PWD/scriptassets.h \
+            $$PWD/providerregistry.h \
+            $$PWD/mprisplayerhost.h \
+            $$PWD/webtab.h \
+            $$PWD/memorymonitor.h
+
+FORMS    += $$PWD/../ui/mainwindow.ui
+
+RESOURCES += $$PWD/../resources/jquery.qrc \
+            $$PWD/../resources/scripts/scripts.qrc \
+            $$PWD/../resources/providers/providers.qrc \
+            $$PWD/../resources/qtwebflix.svg
+
+LIBS += -L$$shadowed($$PWD/../lib) -ldbusextended-qt5 -lmpris-qt5
+
+INCLUDEPATH += $$PWD $$PWD/../lib/qtdbusextended/src $$PWD/../lib/qtmpris/src
+
+
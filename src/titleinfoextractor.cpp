@@ -0,0 +1,64 @@
+#include "titleinfoextractor.h"
+
+namespace {
+
+const QByteArray imageKey = QByteArrayLiteral("\"image\"");
+
+} // namespace
+
+bool TitleInfoExtractor::feed(const QByteArray &chunk) {
+  if (found()) {
+    return true;
+  }
+  m_pending.append(chunk);
+
+  int from = 0;
+  for (;;) {
+    int key = m_pending.indexOf(imageKey, from);
+    if (key < 0) {
+      // Keep just enough for a key split across chunks.
+      m_pending = m_pending.right(imageKey.size() - 1);
+      return false;
+    }
+
+    // Same shape as before: "image": *"([^"]*)"
+    int p = key + imageKey.size();
+    if (p < m_pending.size() && m_pending[p] != ':') {
+      from = p;
+      continue;
+    }
+    ++p;
+    while (p < m_pending.size() && m_pending[p] == ' ') {
+      ++p;
+    }
+    if (p < m_pending.size() && m_pending[p] != '"') {
+      from = p;
+      continue;
+    }
+
+    int end = p < m_pending.size() ? m_pending.indexOf('"', p + 1) : -1;
+    if (end < 0) {
+      // The value is not complete yet, wait for more data.
+      m_pending = m_pending.mid(key);
+      return false;
+    }
+
+    if (end == p + 1) {
+      from = end + 1;
+      continue;
+    }
+
+    m_artUrl = QString::fromUtf8(m_pending.mid(p + 1, end - p - 1));
+    m_pending.clear();
+    return true;
+  }
+}
+
+bool TitleInfoExtractor::found() const { return !m_artUrl.isEmpty(); }
+
+QString TitleInfoExtractor::artUrl() const { return m_artUrl; }
+
+void TitleInfoExtractor::reset() {
+  m_pending.clear();
+  m_artUrl.clear();
+}
@@ -0,0 +1,23 @@
+#ifndef TITLEINFOEXTRACTOR_H
+#define TITLEINFOEXTRACTOR_H
+
+#include <QByteArray>
+#include <QString>
+
+// Looks for the `"image": "<url>"` field of a Netflix title page while it is
+// being downloaded, so that the download can stop as soon as it shows up.
+// Only the bytes that could still be part of a match are kept around.
+class TitleInfoExtractor {
+public:
+  // Scans the next chunk of the page. Returns true once the art URL is known.
+  bool feed(const QByteArray &chunk);
+  bool found() const;
+  QString artUrl() const;
+  void reset();
+
+private:
+  QByteArray m_pending;
+  QString m_artUrl;
+};
+
+#endif // TITLEINFOEXTRACTOR_H
@@ -0,0 +1,95 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "tracer.h"
+
+Tracer &Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() { m_clock.start(); }
+
+void Tracer::enable(const QString &fileName) {
+  m_fileName = fileName;
+  m_enabled = true;
+}
+
+bool Tracer::isEnabled() const { return m_enabled; }
+
+qint64 Tracer::now() const { return m_clock.nsecsElapsed() / 1000; }
+
+void Tracer::complete(const char *name, qint64 start, qint64 duration) {
+  if (!m_enabled) {
+    return;
+  }
+  std::lock_guard<std::mutex> l(m_mutex);
+  m_events.append({name, 'X', start, duration});
+}
+
+void Tracer::instant(const char *name) {
+  if (!m_enabled) {
+    return;
+  }
+  qint64 start = now();
+  std::lock_guard<std::mutex> l(m_mutex);
+  for (const auto &event : m_events) {
+    if (event.phase == 'i' && qstrcmp(event.name, name) == 0) {
+      return;
+    }
+  }
+  m_events.append({name, 'i', start, 0});
+}
+
+void Tracer::save() {
+  if (!m_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> l(m_mutex);
+  qint64 pid = QCoreApplication::applicationPid();
+
+  QJsonArray events;
+  for (const auto &event : m_events) {
+    QJsonObject object;
+    object["name"] = QString::fromLatin1(event.name);
+    object["cat"] = "startup";
+    object["ph"] = QString(QChar::fromLatin1(event.phase));
+    object["ts"] = static_cast<double>(event.start);
+    object["pid"] = static_cast<double>(pid);
+    object["tid"] = 1;
+    if (event.phase == 'X') {
+      object["dur"] = static_cast<double>(event.duration);
+    } else {
+      // Draw milestones across the whole process.
+      object["s"] = "p";
+    }
+    events.append(object);
+  }
+
+  QJsonObject trace;
+  trace["traceEvents"] = events;
+  trace["displayTimeUnit"] = "ms";
+
+  QSaveFile file(m_fileName);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "Could not write trace" << m_fileName;
+    return;
+  }
+  file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+  file.commit();
+
+  qDebug() << "Wrote" << m_events.size() << "trace events to" << m_fileName;
+}
+
+TraceScope::TraceScope(const char *name)
+    : m_name(name), m_start(Tracer::instance().now()) {}
+
+TraceScope::~TraceScope() {
+  Tracer &tracer = Tracer::instance();
+  tracer.complete(m_name, m_start, tracer.now() - m_start);
+}
@@ -0,0 +1,59 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <mutex>
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Records startup phases and milestones as Chrome trace events, viewable in
+// chrome://tracing or Perfetto. Recording is a no-op until enabled, so the
+// scopes can stay in place permanently.
+class Tracer {
+public:
+  static Tracer &instance();
+
+  // Starts recording, events are written to `fileName` by save().
+  void enable(const QString &fileName);
+  bool isEnabled() const;
+
+  // Microseconds since the process started tracing.
+  qint64 now() const;
+
+  void complete(const char *name, qint64 start, qint64 duration);
+  // Records a milestone, only the first one of each name is kept.
+  void instant(const char *name);
+
+  void save();
+
+private:
+  Tracer();
+
+  struct Event {
+    const char *name;
+    char phase;
+    qint64 start;
+    qint64 duration;
+  };
+
+  QElapsedTimer m_clock;
+  QString m_fileName;
+  bool m_enabled = false;
+
+  std::mutex m_mutex;
+  QVector<Event> m_events;
+};
+
+// Records the lifetime of the enclosing scope as one complete event.
+class TraceScope {
+public:
+  explicit TraceScope(const char *name);
+  ~TraceScope();
+
+private:
+  const char *m_name;
+  qint64 m_start;
+};
+
+#endif // TRACER_H
@@ -1,26 +1,76 @@
 #include <QWebEngineUrlRequestInterceptor>
 #include <QDebug>
+#include <algorithm>
 
 #include "urlrequestinterceptor.h"
 
-UrlRequestInterceptor::UrlRequestInterceptor(QObject *parent)
-    : QWebEngineUrlRequestInterceptor(parent)
+UrlRequestInterceptor::UrlRequestInterceptor(const UrlRuleSet &rules,
+                                             QObject *parent)
+    : QWebEngineUrlRequestInterceptor(parent), m_rules(rules),
+      m_hits(rules.size())
 {
 }
 
+void UrlRequestInterceptor::setCapture(NetworkCapture *capture)
+{
+    m_capture = capture;
+}
+
 void UrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
 {
-    static const QRegExp netflix1080p_pattern(R"(.*\:\/\/assets\.nflxext\.com\/.*\/ffe\/player\/html\/.*|)"
-                                                  R"(.*\:\/\/www\.assets\.nflxext\.com\/.*\/ffe\/player\/html\/.*)");
-
-        if (netflix1080p_pattern.exactMatch(info.requestUrl().toString()))
-        {
-            qDebug() << "Netflix Player detected! Injecting Netflix 1080p Unlocker...";
-            //info.redirect(QUrl("https://rawgit.com/gort818/netflix-1080p/master/cadmium-playercore-6.0009.325.011-1080p.js"));
-
-            // old playercore still works but a lot fo shows no longer play in 1080
-            //info.redirect(QUrl("https://rawcdn.githack.com/gort818/netflix-1080p/a225d19994546396f252a169704e2bde43e5ff7d/playercore-481.js"));
-            //new playercore (ctrl + alt + shift + s no longer working
-            info.redirect(QUrl("https://rawcdn.githack.com/gort818/netflix-1080p/15c20e1d1880cc19414840d413e940c34b1bb438/playercore-6.0011.853.051.js"));
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+
+    int index = m_rules.match(info.requestUrl());
+    if (index < 0) {
+        if (m_capture)
+            m_capture->recordRequest(info, "none", QString());
+        return;
+    }
+
+    m_hits[index].fetch_add(1, std::memory_order_relaxed);
+
+    const UrlRule &rule = m_rules.rule(index);
+    QString action;
+    switch (rule.action) {
+    case UrlRule::Redirect:
+        qDebug() << "Interceptor rule" << rule.name << "redirecting to"
+                 << rule.target;
+        info.redirect(rule.target);
+        action = "redirect";
+        break;
+    case UrlRule::Block:
+        info.block(true);
+        action = "block";
+        break;
+    case UrlRule::Allow:
+        action = "allow";
+        break;
+    }
+
+    if (m_capture)
+        m_capture->recordRequest(info, action, rule.name);
+}
+
+void UrlRequestInterceptor::logStatistics() const
+{
+    QVector<QPair<quint64, int>> hits;
+    quint64 blocked = 0;
+    for (int i = 0; i < m_rules.size(); ++i) {
+        quint64 count = m_hits[i].load(std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+        hits.append(qMakePair(count, i));
+        if (m_rules.rule(i).action == UrlRule::Block)
+            blocked += count;
+    }
+    std::sort(hits.begin(), hits.end(),
+              [](const QPair<quint64, int> &a, const QPair<quint64, int> &b) {
+                  return a.first > b.first;
+              });
+
+    qDebug() << "Interceptor:" << m_requests.load(std::memory_order_relaxed)
+             << "requests," << blocked << "blocked";
+    for (const auto &hit : hits) {
+        qDebug() << "  " << hit.first << m_rules.rule(hit.second).name;
     }
 }
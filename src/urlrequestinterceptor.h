@@ -2,14 +2,33 @@
 #define URLREQUESTINTERCEPTOR_H
 
 #include <QWebEngineUrlRequestInterceptor>
+#include <atomic>
+#include <vector>
+
+#include "networkcapture.h"
+#include "urlrules.h"
 
 class UrlRequestInterceptor : public QWebEngineUrlRequestInterceptor
 {
     Q_OBJECT
 
 public:
-    UrlRequestInterceptor(QObject *parent = nullptr);
+    UrlRequestInterceptor(const UrlRuleSet &rules, QObject *parent = nullptr);
     void interceptRequest(QWebEngineUrlRequestInfo &info) override;
+
+    // Records every request into `capture`. Set before installing.
+    void setCapture(NetworkCapture *capture);
+
+    // Logs how often each rule matched, busiest first.
+    void logStatistics() const;
+
+private:
+    // Only read once installed, requests are intercepted on the IO thread.
+    const UrlRuleSet m_rules;
+    // Hits per rule, written from the IO thread.
+    std::vector<std::atomic<quint64>> m_hits;
+    std::atomic<quint64> m_requests{0};
+    NetworkCapture *m_capture = nullptr;
 };
 
 #endif // URLREQUESTINTERCEPTOR_H
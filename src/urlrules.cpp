@@ -0,0 +1,260 @@
+#include <QDebug>
+#include <QFile>
+#include <QSettings>
+#include <QTextStream>
+
+#include "urlrules.h"
+
+namespace {
+
+// Translates a filter list pattern to a regular expression: `*` is a
+// wildcard, `^` a separator character or the end of the path, and a
+// trailing `|` anchors the pattern to the end.
+QString filterToRegExp(QString pattern) {
+  bool anchored = pattern.endsWith('|');
+  if (anchored) {
+    pattern.chop(1);
+  }
+  QString regexp;
+  for (const QChar c : pattern) {
+    if (c == '*') {
+      regexp += ".*";
+    } else if (c == '^') {
+      regexp += "(?:[/?&=:]|$)";
+    } else {
+      regexp += QRegularExpression::escape(QString(c));
+    }
+  }
+  if (anchored) {
+    regexp += '$';
+  }
+  return regexp;
+}
+
+} // namespace
+
+UrlRuleSet UrlRuleSet::defaults() {
+  UrlRuleSet rules;
+
+  // Netflix 1080p unlocker. The old playercore still works but a lot of shows
+  // no longer play in 1080:
+  // https://rawcdn.githack.com/gort818/netflix-1080p/a225d19994546396f252a169704e2bde43e5ff7d/playercore-481.js
+  UrlRule netflix1080p;
+  netflix1080p.name = "netflix-1080p";
+  netflix1080p.host = "assets.nflxext.com";
+  netflix1080p.path = QRegularExpression("/ffe/player/html/");
+  netflix1080p.target =
+      QUrl("https://rawcdn.githack.com/gort818/netflix-1080p/"
+           "15c20e1d1880cc19414840d413e940c34b1bb438/"
+           "playercore-6.0011.853.051.js");
+  rules.addRule(netflix1080p);
+
+  return rules;
+}
+
+bool UrlRuleSet::load(QSettings &settings) {
+  settings.beginGroup("interceptor");
+  int count = settings.beginReadArray("rules");
+  for (int i = 0; i < count; ++i) {
+    settings.setArrayIndex(i);
+
+    UrlRule rule;
+    rule.name = settings.value("name", QString("rule-%1").arg(i)).toString();
+    rule.host = settings.value("host").toString();
+    rule.path = QRegularExpression(settings.value("path").toString());
+    QString redirect = settings.value("redirect").toString();
+    if (redirect.isEmpty()) {
+      rule.action = UrlRule::Block;
+    } else {
+      rule.action = UrlRule::Redirect;
+      rule.target = QUrl(redirect);
+    }
+
+    if (rule.host.isEmpty() || !rule.path.isValid()) {
+      qDebug() << "Ignoring invalid interceptor rule" << rule.name;
+      continue;
+    }
+    addRule(rule);
+  }
+  settings.endArray();
+  settings.endGroup();
+
+  return count > 0;
+}
+
+int UrlRuleSet::loadFilterList(const QString &fileName) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return 0;
+  }
+
+  int added = 0;
+  int skipped = 0;
+  QTextStream in(&file);
+  while (!in.atEnd()) {
+    QString line = in.readLine().trimmed();
+    if (line.isEmpty() || line.startsWith('!') || line.startsWith('[')) {
+      continue;
+    }
+
+    UrlRule rule;
+    rule.name = line;
+    rule.action = UrlRule::Block;
+    if (line.startsWith("@@")) {
+      rule.action = UrlRule::Allow;
+      line.remove(0, 2);
+    }
+
+    // Element hiding, options and full-URL anchors change what a rule means
+    // in ways a request filter cannot honour, so those rules are skipped.
+    if (line.contains("##") || line.contains("#@#") || line.contains('$') ||
+        (line.startsWith('|') && !line.startsWith("||"))) {
+      ++skipped;
+      continue;
+    }
+
+    QString pattern;
+    if (line.startsWith("||")) {
+      line.remove(0, 2);
+      int end = 0;
+      while (end < line.size() && line[end] != '^' && line[end] != '/' &&
+             line[end] != '*' && line[end] != '|') {
+        ++end;
+      }
+      if ((end < line.size() && line[end] == '*') ||
+          line.left(end).endsWith('.')) {
+        // A wildcard in the host, as in `||ads.*^`, leaves no suffix to
+        // look up, so the pattern is run against the full URL from the
+        // start of a host label instead.
+        pattern = "^[a-z][a-z0-9+.-]*://(?:[^/?#]*\\.)?" +
+                  filterToRegExp(line);
+        rule.fullUrl = true;
+      } else {
+        rule.host = line.left(end);
+        QString rest = line.mid(end);
+        if (rest.startsWith('^')) {
+          rest.remove(0, 1);
+        }
+        if (!rest.isEmpty()) {
+          pattern = '^' + filterToRegExp(rest.startsWith('/') ||
+                                                 rest.startsWith('*')
+                                             ? rest
+                                             : '/' + rest);
+        }
+      }
+    } else {
+      // Plain patterns such as `adserver.` or `track.js?host=` may match
+      // anywhere in the URL, the host included.
+      pattern = filterToRegExp(line);
+      rule.fullUrl = true;
+    }
+
+    // Filter lists are case-insensitive unless a rule says `$match-case`,
+    // and rules with options are skipped above.
+    rule.path =
+        QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
+    if (!rule.path.isValid() || (rule.host.isEmpty() && pattern.isEmpty())) {
+      ++skipped;
+      continue;
+    }
+    addRule(rule);
+    ++added;
+  }
+
+  qDebug() << "Filter list" << fileName << ":" << added << "rules compiled,"
+           << skipped << "unsupported rules skipped";
+  return added;
+}
+
+void UrlRuleSet::addRule(const UrlRule &rule) {
+  m_rules.append(rule);
+  UrlRule &added = m_rules.last();
+  added.host = added.host.toLower();
+  added.path.optimize();
+
+  int index = m_rules.size() - 1;
+  if (added.host.isEmpty()) {
+    m_anyHost.append(index);
+  } else {
+    m_byHost[qHash(added.host)].append(index);
+  }
+  if (added.action == UrlRule::Allow) {
+    m_hasExceptions = true;
+  }
+  if (added.fullUrl) {
+    m_hasFullUrlRules = true;
+  }
+}
+
+bool UrlRuleSet::matches(int index, const QUrl &url, QString &path,
+                         const QString &full) const {
+  const UrlRule &rule = m_rules[index];
+  if (rule.path.pattern().isEmpty()) {
+    return true;
+  }
+  if (rule.fullUrl) {
+    return rule.path.match(full).hasMatch();
+  }
+  if (path.isNull()) {
+    path = url.path();
+  }
+  return rule.path.match(path).hasMatch();
+}
+
+int UrlRuleSet::match(const QUrl &url) const {
+  if (m_rules.isEmpty()) {
+    return -1;
+  }
+
+  // QUrl keeps hosts lower-cased, so no normalisation is needed here.
+  const QString host = url.host();
+  QString path;
+  const QString full =
+      m_hasFullUrlRules ? url.toString(QUrl::FullyEncoded) : QString();
+  int found = -1;
+
+  // Returns true once the search can stop.
+  auto consider = [&](int index) {
+    if (found >= 0 && m_rules[index].action != UrlRule::Allow) {
+      return false;
+    }
+    if (!matches(index, url, path, full)) {
+      return false;
+    }
+    found = index;
+    return m_rules[index].action == UrlRule::Allow || !m_hasExceptions;
+  };
+
+  int start = 0;
+  while (start >= 0) {
+    QStringRef suffix = host.midRef(start);
+    auto it = m_byHost.constFind(qHash(suffix));
+    if (it != m_byHost.constEnd()) {
+      for (int index : it.value()) {
+        if (m_rules[index].host == suffix && consider(index)) {
+          return found;
+        }
+      }
+    }
+
+    start = host.indexOf('.', start);
+    if (start >= 0) {
+      ++start;
+    }
+  }
+
+  for (int index : m_anyHost) {
+    if (consider(index)) {
+      return found;
+    }
+  }
+  return found;
+}
+
+void UrlRuleSet::setTarget(int index, const QUrl &target) {
+  m_rules[index].target = target;
+}
+
+int UrlRuleSet::size() const { return m_rules.size(); }
+
+const UrlRule &UrlRuleSet::rule(int index) const { return m_rules[index]; }
@@ -0,0 +1,68 @@
+#ifndef URLRULES_H
+#define URLRULES_H
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+
+class QSettings;
+
+struct UrlRule {
+  enum Action { Redirect, Block, Allow };
+
+  QString name;
+  // Matches this host and all of its subdomains, an empty host matches any.
+  QString host;
+  // Searched for in the request path, an empty pattern matches every path.
+  QRegularExpression path;
+  // Search `path` in the full URL instead, as filter list rules without a
+  // host anchor expect.
+  bool fullUrl = false;
+  Action action = Redirect;
+  QUrl target;
+};
+
+// Interceptor rules indexed by host. A lookup hashes each dot-separated
+// suffix of the request host, so it costs O(host length); path patterns are
+// only run for rules whose host matched, plus the (usually few) rules that
+// apply to any host. The full URL string is built once per request, and
+// only if some rule is a plain filter list pattern.
+class UrlRuleSet {
+public:
+  // The built-in rules, used when the settings define none.
+  static UrlRuleSet defaults();
+
+  // Reads the `interceptor/rules` array from `settings`. Returns false if
+  // there is none.
+  bool load(QSettings &settings);
+
+  // Compiles the blocking and exception rules of an Adblock Plus style filter
+  // list. Returns the number of rules added.
+  int loadFilterList(const QString &fileName);
+
+  void addRule(const UrlRule &rule);
+  void setTarget(int index, const QUrl &target);
+  // Index of the rule matching `url`, or -1. Exception rules win over
+  // everything else.
+  int match(const QUrl &url) const;
+
+  int size() const;
+  const UrlRule &rule(int index) const;
+
+private:
+  // `path` is filled in on first use and shared by the rules tried for one
+  // request, `full` is the URL string built by match().
+  bool matches(int index, const QUrl &url, QString &path,
+               const QString &full) const;
+
+  QVector<UrlRule> m_rules;
+  // qHash of the host suffix -> indices into `m_rules`.
+  QHash<uint, QVector<int>> m_byHost;
+  QVector<int> m_anyHost;
+  bool m_hasExceptions = false;
+  bool m_hasFullUrlRules = false;
+};
+
+#endif // URLRULES_H
@@ -0,0 +1,28 @@
+#include <QDebug>
+#include <QWebChannel>
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+
+#include "scriptassets.h"
+#include "videobridge.h"
+
+VideoBridge::VideoBridge(QObject *parent)
+    : QObject(parent), m_channel(new QWebChannel(this)) {
+  m_channel->registerObject(QStringLiteral("videoBridge"), this);
+}
+
+void VideoBridge::attach(QWebEnginePage *page, ScriptAssets *assets) {
+  QString source = assets->install(
+      page->scripts(), QStringLiteral("qtwebflix-videobridge"),
+      {"qwebchannel", "videobridge"}, QWebEngineScript::ApplicationWorld);
+  if (source.isNull()) {
+    qDebug() << "Video bridge disabled";
+    return;
+  }
+
+  page->setWebChannel(m_channel, QWebEngineScript::ApplicationWorld);
+}
+
+void VideoBridge::videoEvent(const QString &type, const QVariantMap &state) {
+  emit videoStateChanged(type, state);
+}
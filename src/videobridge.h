@@ -0,0 +1,35 @@
+#ifndef VIDEOBRIDGE_H
+#define VIDEOBRIDGE_H
+
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+class QWebChannel;
+class QWebEnginePage;
+class ScriptAssets;
+
+// Receives <video> events pushed by resources/scripts/videobridge.js over a
+// QWebChannel. The listener lives in the application world so that pages
+// cannot see or tamper with it.
+class VideoBridge : public QObject {
+  Q_OBJECT
+
+public:
+  explicit VideoBridge(QObject *parent = nullptr);
+
+  void attach(QWebEnginePage *page, ScriptAssets *assets);
+
+public slots:
+  // Invoked from JavaScript. `state` holds state, position, duration, volume
+  // and rate of the video element that fired `type`.
+  void videoEvent(const QString &type, const QVariantMap &state);
+
+signals:
+  void videoStateChanged(const QString &type, const QVariantMap &state);
+
+private:
+  QWebChannel *m_channel;
+};
+
+#endif // VIDEOBRIDGE_H
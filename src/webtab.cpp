@@ -0,0 +1,105 @@
+#include <QDebug>
+#include <QWebEnginePage>
+#include <QWebEngineScriptCollection>
+#include <QWebEngineSettings>
+
+#include "scriptassets.h"
+#include "videobridge.h"
+#include "webtab.h"
+
+WebTab::WebTab(ScriptAssets *assets, int freezeAfter, int discardAfter,
+               QObject *parent)
+    : QObject(parent), m_view(new QWebEngineView),
+      m_bridge(new VideoBridge(this)) {
+  // Push <video> events to MPRIS instead of polling for them.
+  m_bridge->attach(m_view->page(), assets);
+
+  m_view->settings()->setAttribute(
+      QWebEngineSettings::FullScreenSupportEnabled, true);
+// Check for QT if equal or greater than 5.10 hide scrollbars
+#if HAS_SCROLLBAR
+  m_view->settings()->setAttribute(QWebEngineSettings::ShowScrollBars, false);
+#endif
+
+  m_freezeTimer.setSingleShot(true);
+  m_freezeTimer.setInterval(freezeAfter * 1000);
+  connect(&m_freezeTimer, SIGNAL(timeout()), this, SLOT(freezeTimerFired()));
+
+  m_discardTimer.setSingleShot(true);
+  m_discardTimer.setInterval(discardAfter * 1000);
+  connect(&m_discardTimer, SIGNAL(timeout()), this,
+          SLOT(discardTimerFired()));
+}
+
+WebTab::~WebTab() { delete m_view; }
+
+QWebEngineView *WebTab::view() const { return m_view; }
+
+VideoBridge *WebTab::bridge() const { return m_bridge; }
+
+bool WebTab::isForeground() const { return m_foreground; }
+
+void WebTab::setForeground(bool foreground) {
+  if (m_foreground == foreground) {
+    return;
+  }
+  m_foreground = foreground;
+
+  if (foreground) {
+    m_freezeTimer.stop();
+    m_discardTimer.stop();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    // A discarded page reloads when it becomes active again.
+    m_view->page()->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+#endif
+    return;
+  }
+
+  if (m_freezeTimer.interval() > 0) {
+    m_freezeTimer.start();
+  }
+  if (m_discardTimer.interval() > 0) {
+    m_discardTimer.start();
+  }
+}
+
+bool WebTab::discard() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  QWebEnginePage *page = m_view->page();
+  if (m_foreground ||
+      page->recommendedState() != QWebEnginePage::LifecycleState::Discarded ||
+      page->lifecycleState() == QWebEnginePage::LifecycleState::Discarded) {
+    return false;
+  }
+  qDebug() << "Discarding background tab" << m_view->url().host();
+  page->setLifecycleState(QWebEnginePage::LifecycleState::Discarded);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void WebTab::freezeTimerFired() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  QWebEnginePage *page = m_view->page();
+  if (page->recommendedState() == QWebEnginePage::LifecycleState::Active) {
+    // Still audible or otherwise busy, try again later.
+    m_freezeTimer.start();
+    return;
+  }
+  if (page->lifecycleState() == QWebEnginePage::LifecycleState::Active) {
+    qDebug() << "Freezing background tab" << m_view->url().host();
+    page->setLifecycleState(QWebEnginePage::LifecycleState::Frozen);
+  }
+#endif
+}
+
+void WebTab::discardTimerFired() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  if (!discard() && !m_foreground &&
+      m_view->page()->lifecycleState() !=
+          QWebEnginePage::LifecycleState::Discarded) {
+    m_discardTimer.start();
+  }
+#endif
+}
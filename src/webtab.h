@@ -0,0 +1,46 @@
+#ifndef WEBTAB_H
+#define WEBTAB_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QWebEngineView>
+
+class ScriptAssets;
+class VideoBridge;
+
+// One tab: a view on the shared profile with its own video bridge. While in
+// the background the page is frozen and later discarded, unless Chromium
+// recommends keeping it active, e.g. because it is playing audio.
+class WebTab : public QObject {
+  Q_OBJECT
+
+public:
+  // Timeouts are in seconds, 0 disables the step.
+  WebTab(ScriptAssets *assets, int freezeAfter, int discardAfter,
+         QObject *parent = nullptr);
+  ~WebTab();
+
+  QWebEngineView *view() const;
+  VideoBridge *bridge() const;
+
+  void setForeground(bool foreground);
+  bool isForeground() const;
+  // Discards the page right away if it is in the background and may be
+  // discarded. Returns true if it was.
+  bool discard();
+
+private slots:
+  void freezeTimerFired();
+  void discardTimerFired();
+
+private:
+  // Owned, but placed in the tab widget, which may delete it first.
+  QPointer<QWebEngineView> m_view;
+  VideoBridge *m_bridge;
+  bool m_foreground = false;
+  QTimer m_freezeTimer;
+  QTimer m_discardTimer;
+};
+
+#endif // WEBTAB_H